@@ -0,0 +1,156 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <chrono>
+#include <string>
+#include "clocking.h"
+
+// =============================================================================
+// Simulation throughput benchmarks - shared by bench_counter and bench_fifo
+//
+// Each run measures one DUT configuration in one mode:
+//   dut       Verilated DUT only, replaying pre-generated stimulus
+//   model     Zig reference model only
+//   lockstep  both, checked against each other the way the testbenches do
+// and appends one CSV line to --out for bench_compare to check against a
+// stored baseline.
+// =============================================================================
+
+enum BenchMode { BENCH_DUT, BENCH_MODEL, BENCH_LOCKSTEP };
+
+struct BenchOptions {
+    BenchMode mode;      // --mode dut|model|lockstep
+    uint64_t cycles;     // --cycles N
+    const char* out;     // --out FILE: append the result as CSV
+    ClockMode clocking;  // --clocking elide|two-edge|check (anything but elide is
+                         // tagged onto the config so it never meets the
+                         // baseline of the other)
+};
+
+inline const char* bench_mode_name(BenchMode m) {
+    return m == BENCH_DUT ? "dut" : m == BENCH_MODEL ? "model" : "lockstep";
+}
+
+inline BenchOptions bench_parse_options(int argc, char** argv) {
+    BenchOptions opts;
+    opts.mode = BENCH_LOCKSTEP;
+    opts.cycles = 10000000;
+    opts.out = NULL;
+    opts.clocking = CLOCK_ELIDE;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--cycles") == 0) opts.cycles = strtoull(argv[i + 1], NULL, 0);
+        if (strcmp(argv[i], "--out") == 0) opts.out = argv[i + 1];
+        if (strcmp(argv[i], "--clocking") == 0) {
+            int m = parse_clock_mode(argv[i + 1]);
+            if (m < 0) {
+                fprintf(stderr, "Unknown --clocking '%s' (expected elide, two-edge or check)\n", argv[i + 1]);
+                exit(1);
+            }
+            opts.clocking = (ClockMode)m;
+        }
+        if (strcmp(argv[i], "--mode") == 0) {
+            const char* m = argv[i + 1];
+            if (strcmp(m, "dut") == 0) {
+                opts.mode = BENCH_DUT;
+            } else if (strcmp(m, "model") == 0) {
+                opts.mode = BENCH_MODEL;
+            } else if (strcmp(m, "lockstep") == 0) {
+                opts.mode = BENCH_LOCKSTEP;
+            } else {
+                fprintf(stderr, "Unknown --mode '%s' (expected dut, model or lockstep)\n", m);
+                exit(1);
+            }
+        }
+    }
+    return opts;
+}
+
+// Accumulates the time spent in a section that is entered many times
+class BenchTimer {
+private:
+    std::chrono::steady_clock::time_point started;
+    double total;
+
+public:
+    BenchTimer() : total(0) {}
+    void start() { started = std::chrono::steady_clock::now(); }
+    void stop() {
+        total += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+    double seconds() const { return total; }
+};
+
+// Peak resident set size of this process so far, in KiB
+inline long bench_peak_rss_kb() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+    return ru.ru_maxrss / 1024;   // bytes on macOS
+#else
+    return ru.ru_maxrss;
+#endif
+}
+
+struct BenchResult {
+    const char* bench;
+    BenchMode mode;
+    std::string config;
+    uint64_t cycles;
+    double seconds;        // whole run
+    uint64_t evals;        // DUT eval() calls (0 in model mode)
+    double eval_seconds;   // time inside them
+    double model_seconds;  // time inside the reference model (0 in dut mode)
+    uint64_t mismatches;   // lockstep only; a benchmark that mismatches is invalid
+};
+
+// Configuration name as reported, e.g. "64x16" or "64x16/two-edge"
+inline std::string bench_config(const BenchOptions& opts, const std::string& config) {
+    return opts.clocking == CLOCK_ELIDE ? config : config + "/" + clock_mode_name(opts.clocking);
+}
+
+inline double bench_ns_per_eval(const BenchResult& r) {
+    return r.evals ? r.eval_seconds * 1e9 / r.evals : 0;
+}
+
+inline double bench_ns_per_tick(const BenchResult& r) {
+    return r.mode != BENCH_DUT && r.cycles ? r.model_seconds * 1e9 / r.cycles : 0;
+}
+
+inline void bench_report(const BenchResult& r) {
+    long rss = bench_peak_rss_kb();
+    printf("%-8s %-9s %-14s %12llu cycles  %8.3f s  %12.0f cycles/s", r.bench,
+           bench_mode_name(r.mode), r.config.c_str(), (unsigned long long)r.cycles, r.seconds,
+           r.cycles / r.seconds);
+    if (r.evals) printf("  %6.1f ns/eval", bench_ns_per_eval(r));
+    if (r.mode != BENCH_DUT) printf("  %6.1f ns/tick", bench_ns_per_tick(r));
+    printf("  %ld KiB peak RSS\n", rss);
+    if (r.mismatches) printf("  [ERROR] %llu mismatches\n", (unsigned long long)r.mismatches);
+}
+
+// Append one CSV line (with a header if the file is new)
+inline bool bench_write(const char* path, const BenchResult& r) {
+    FILE* f = fopen(path, "a");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    if (ftell(f) == 0) {
+        fprintf(f, "bench,mode,config,cycles,seconds,cycles_per_sec,ns_per_eval,ns_per_tick,peak_rss_kb\n");
+    }
+    fprintf(f, "%s,%s,%s,%llu,%.6f,%.1f,%.3f,%.3f,%ld\n", r.bench, bench_mode_name(r.mode),
+            r.config.c_str(), (unsigned long long)r.cycles, r.seconds, r.cycles / r.seconds,
+            bench_ns_per_eval(r), bench_ns_per_tick(r), bench_peak_rss_kb());
+    return fclose(f) == 0;
+}
+
+// Report, record, and turn the result into an exit status
+inline int bench_finish(const BenchOptions& opts, const BenchResult& r) {
+    bench_report(r);
+    if (opts.out && !bench_write(opts.out, r)) {
+        fprintf(stderr, "Could not append to %s\n", opts.out);
+        return 1;
+    }
+    return r.mismatches ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+// Compare benchmark results (bench_* --out) against a stored baseline and
+// fail if throughput dropped, or peak memory grew, by more than a threshold.
+//
+// usage: bench_compare baseline.csv results.csv [--threshold PERCENT]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct BenchRow {
+    std::string key;          // bench/mode/config
+    double cycles_per_sec;
+    double peak_rss_kb;
+};
+
+// Rows of a results file, skipping the header
+bool read_rows(const char* path, std::vector<BenchRow>& rows) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        std::vector<std::string> cols;
+        for (char* tok = strtok(line, ",\n"); tok; tok = strtok(NULL, ",\n")) cols.push_back(tok);
+        if (cols.size() < 9 || cols[0] == "bench") continue;
+
+        BenchRow r;
+        r.key = cols[0] + "/" + cols[1] + "/" + cols[2];
+        r.cycles_per_sec = atof(cols[5].c_str());
+        r.peak_rss_kb = atof(cols[8].c_str());
+        rows.push_back(r);
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* paths[2] = {NULL, NULL};
+    double threshold = 10;
+    int n_paths = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (n_paths < 2) {
+            paths[n_paths++] = argv[i];
+        }
+    }
+    if (n_paths != 2) {
+        fprintf(stderr, "usage: bench_compare baseline.csv results.csv [--threshold PERCENT]\n");
+        return 1;
+    }
+
+    std::vector<BenchRow> base, cur;
+    if (!read_rows(paths[0], base) || !read_rows(paths[1], cur)) {
+        fprintf(stderr, "bench_compare: cannot read %s or %s\n", paths[0], paths[1]);
+        return 1;
+    }
+
+    printf("%-28s %14s %14s %8s %8s\n", "benchmark", "baseline c/s", "current c/s", "speed", "rss");
+    int regressions = 0;
+    for (const BenchRow& c : cur) {
+        const BenchRow* b = NULL;
+        for (const BenchRow& row : base) {
+            if (row.key == c.key) b = &row;
+        }
+        if (!b) {
+            printf("%-28s %14s %14.0f   (no baseline)\n", c.key.c_str(), "-", c.cycles_per_sec);
+            continue;
+        }
+
+        double speed = (c.cycles_per_sec / b->cycles_per_sec - 1) * 100;
+        double rss = b->peak_rss_kb > 0 ? (c.peak_rss_kb / b->peak_rss_kb - 1) * 100 : 0;
+        bool bad = speed < -threshold || rss > threshold;
+        regressions += bad;
+        printf("%-28s %14.0f %14.0f %+7.1f%% %+7.1f%%%s\n", c.key.c_str(), b->cycles_per_sec,
+               c.cycles_per_sec, speed, rss, bad ? "  REGRESSION" : "");
+    }
+
+    if (regressions) {
+        printf("\n%d benchmark(s) regressed by more than %.1f%%\n", regressions, threshold);
+        return 1;
+    }
+    printf("\nNo regressions beyond %.1f%%\n", threshold);
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "Vcounter.h"
+#if __has_include("Vcounter___024root.h")
+#include "Vcounter___024root.h"
+#endif
+#include "verilated.h"
+#include "bench.h"
+#include "counter_model.h"
+
+// =============================================================================
+// Counter throughput benchmark (see bench.h). Counts continuously with enable
+// held high; the model is stepped one tick per cycle, as tb_counter does.
+// =============================================================================
+
+const uint64_t CHUNK_CYCLES = 4096;
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    BenchOptions opts = bench_parse_options(argc, argv);
+
+    Vcounter* dut = new Vcounter;
+    EdgeClock<Vcounter> clock(dut, opts.clocking);
+    counter_init();
+
+    // Reset, then count
+    dut->clk = 0;
+    dut->rst_n = 0;
+    dut->enable = 0;
+    clock.settle();
+    for (int i = 0; i < 4; i++) {
+        clock.tick();
+        counter_tick();
+    }
+    dut->rst_n = 1;
+    dut->enable = 1;
+    clock.settle();
+    counter_set_reset(true);
+    counter_set_enable(true);
+
+    BenchResult r = {};
+    r.bench = "counter";
+    r.mode = opts.mode;
+    r.config = bench_config(opts, "8bit");
+    r.cycles = opts.cycles;
+
+    // Chunks of cycles per side, compared at the end of each chunk: both
+    // sides count freely, so their counts must agree whenever they meet
+    BenchTimer total, dut_time, model_time;
+    total.start();
+    for (uint64_t done = 0; done < opts.cycles; ) {
+        uint64_t n = std::min(opts.cycles - done, CHUNK_CYCLES);
+
+        if (opts.mode != BENCH_MODEL) {
+            uint64_t before = clock.get_evals();
+            dut_time.start();
+            for (uint64_t i = 0; i < n; i++) clock.tick();
+            dut_time.stop();
+            r.evals += clock.get_evals() - before;
+        }
+        if (opts.mode != BENCH_DUT) {
+            model_time.start();
+            for (uint64_t i = 0; i < n; i++) counter_tick();
+            model_time.stop();
+        }
+        if (opts.mode == BENCH_LOCKSTEP && dut->count != counter_get_count()) r.mismatches++;
+        done += n;
+    }
+    total.stop();
+
+    r.seconds = total.seconds();
+    r.eval_seconds = dut_time.seconds();
+    r.model_seconds = model_time.seconds();
+
+    delete dut;
+    return bench_finish(opts, r);
+}
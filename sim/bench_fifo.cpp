@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "Vfifo.h"
+#if __has_include("Vfifo___024root.h")
+#include "Vfifo___024root.h"
+#endif
+#include "verilated.h"
+#include "fifo_model.h"
+#include "scoreboard.h"
+#include "prng.h"
+#include "bench.h"
+
+// =============================================================================
+// FIFO throughput benchmark (see bench.h). One block of random stimulus is
+// generated up front and replayed, so generation is never part of the timing.
+// =============================================================================
+
+const int BLOCK_CYCLES = 4096;
+const int RESET_CYCLES = 5;
+
+// One block of random enables and data, with reset held for the first cycles
+std::vector<FifoStim> make_stimulus() {
+    std::vector<FifoStim> stim(BLOCK_CYCLES);
+    std::vector<uint64_t> data(BLOCK_CYCLES), coins(BLOCK_CYCLES);
+    Xoshiro256x4 rng(1);
+    rng.fill(data.data(), BLOCK_CYCLES, FIFO_DATA_MASK);
+    rng.fill(coins.data(), BLOCK_CYCLES);
+    for (int i = 0; i < BLOCK_CYCLES; i++) {
+        stim[i] = FifoStim();
+        stim[i].data_in = data[i];
+        stim[i].wr_en = coins[i] & 1;
+        stim[i].rd_en = (coins[i] >> 1) & 1;
+        stim[i].rst_n = 1;
+    }
+    return stim;
+}
+
+// Drive n cycles of stim into the DUT, optionally recording its outputs
+void run_dut(Vfifo* dut, EdgeClock<Vfifo>& clock, const FifoStim* stim, int n, FifoOutputs* out) {
+    for (int i = 0; i < n; i++) {
+        dut->wr_en = stim[i].wr_en;
+        dut->rd_en = stim[i].rd_en;
+        dut->rst_n = stim[i].rst_n;
+        dut->data_in = stim[i].data_in;
+        clock.tick();
+        if (out) {
+            FifoOut o;
+            o.data_out = dut->data_out;
+            o.count = dut->count;
+            o.full = dut->full;
+            o.empty = dut->empty;
+            out->set(i, o);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    BenchOptions opts = bench_parse_options(argc, argv);
+
+    Vfifo* dut = new Vfifo;
+    EdgeClock<Vfifo> clock(dut, opts.clocking);
+    FifoModel model;
+    std::vector<FifoStim> stim = make_stimulus();
+    FifoOutputs rtl_out(BLOCK_CYCLES), ref_out(BLOCK_CYCLES);
+    std::vector<uint64_t> mismatch((BLOCK_CYCLES + 63) / 64);
+
+    // Reset both sides outside the timed region
+    std::vector<FifoStim> reset(RESET_CYCLES, stim[0]);
+    for (FifoStim& s : reset) s.rst_n = 0;
+    run_dut(dut, clock, reset.data(), RESET_CYCLES, NULL);
+    model.step_batch(reset.data(), ref_out.buf(), RESET_CYCLES);
+
+    BenchResult r = {};
+    r.bench = "fifo";
+    r.mode = opts.mode;
+    r.config = bench_config(opts, std::to_string(FIFO_DEPTH) + "x" + std::to_string(FIFO_DATA_WIDTH));
+    r.cycles = opts.cycles;
+
+    BenchTimer total, dut_time, model_time;
+    total.start();
+    for (uint64_t done = 0; done < opts.cycles; ) {
+        int n = (int)std::min<uint64_t>(opts.cycles - done, BLOCK_CYCLES);
+
+        if (opts.mode != BENCH_MODEL) {
+            uint64_t before = clock.get_evals();
+            dut_time.start();
+            run_dut(dut, clock, stim.data(), n, opts.mode == BENCH_LOCKSTEP ? &rtl_out : NULL);
+            dut_time.stop();
+            r.evals += clock.get_evals() - before;
+        }
+        if (opts.mode != BENCH_DUT) {
+            model_time.start();
+            model.step_batch(stim.data(), ref_out.buf(), n);
+            model_time.stop();
+        }
+        if (opts.mode == BENCH_LOCKSTEP) {
+            r.mismatches += scoreboard_compare(rtl_out, ref_out, n, mismatch.data());
+        }
+        done += n;
+    }
+    total.stop();
+
+    r.seconds = total.seconds();
+    r.eval_seconds = dut_time.seconds();
+    r.model_seconds = model_time.seconds();
+
+    delete dut;
+    return bench_finish(opts, r);
+}
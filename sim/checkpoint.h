@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "verilated_save.h"
+
+// =============================================================================
+// Checkpoints - everything needed to resume a testbench mid-run
+//
+// A checkpoint is a Verilator save file, so the DUT must be Verilated with
+// --savable. The testbench's own state comes first, as tagged sections of
+// 64-bit words that each component fills with save_state() and takes back
+// with restore_state(); the Verilated model follows:
+//   "RTLCKPT1"  u64 version  u64 number of sections
+//   per section: u64 tag, u64 word count, the words
+//   model state (VerilatedSave << model)
+// =============================================================================
+class CheckpointData {
+private:
+    static const uint64_t MAGIC = 0x3154504b434c5452ull;   // "RTLCKPT1"
+    static const uint64_t VERSION = 1;
+    static const uint64_t MAX_WORDS = 1ull << 28;          // sanity bound when reading
+
+    std::vector<std::pair<uint64_t, std::vector<uint64_t> > > sections;
+
+public:
+    // The words of section tag, created empty if new
+    std::vector<uint64_t>& section(uint64_t tag) {
+        for (auto& s : sections) {
+            if (s.first == tag) return s.second;
+        }
+        sections.emplace_back(tag, std::vector<uint64_t>());
+        return sections.back().second;
+    }
+
+    // The words of section tag, or an empty list if the checkpoint has none
+    const std::vector<uint64_t>& get(uint64_t tag) const {
+        static const std::vector<uint64_t> none;
+        for (const auto& s : sections) {
+            if (s.first == tag) return s.second;
+        }
+        return none;
+    }
+
+    void write(VerilatedSerialize& os) const {
+        uint64_t hdr[3] = {MAGIC, VERSION, sections.size()};
+        os.write(hdr, sizeof(hdr));
+        for (const auto& s : sections) {
+            uint64_t sec[2] = {s.first, s.second.size()};
+            os.write(sec, sizeof(sec));
+            if (!s.second.empty()) os.write(s.second.data(), s.second.size() * sizeof(uint64_t));
+        }
+    }
+
+    bool read(VerilatedDeserialize& is) {
+        uint64_t hdr[3];
+        is.read(hdr, sizeof(hdr));
+        if (hdr[0] != MAGIC || hdr[1] != VERSION || hdr[2] > 1024) return false;
+        sections.clear();
+        for (uint64_t i = 0; i < hdr[2]; i++) {
+            uint64_t sec[2];
+            is.read(sec, sizeof(sec));
+            if (sec[1] > MAX_WORDS) return false;
+            std::vector<uint64_t>& words = section(sec[0]);
+            words.resize(sec[1]);
+            if (!words.empty()) is.read(words.data(), words.size() * sizeof(uint64_t));
+        }
+        return true;
+    }
+};
+
+// Write sections and DUT to path; the file only replaces an existing one
+// once it is complete, so a crash mid-write keeps the previous checkpoint
+template <typename DUT>
+bool checkpoint_save(const char* path, const CheckpointData& data, DUT& dut) {
+    std::string tmp = std::string(path) + ".tmp";
+    VerilatedSave os;
+    os.open(tmp.c_str());
+    if (!os.isOpen()) return false;
+    data.write(os);
+    os << dut;
+    os.close();
+    return rename(tmp.c_str(), path) == 0;
+}
+
+// Reading takes two steps, so the caller can check the sections (e.g. that
+// the checkpoint is for this configuration) before the DUT is overwritten
+class CheckpointReader {
+private:
+    VerilatedRestore is;
+    CheckpointData data;
+
+public:
+    bool open(const char* path) {
+        is.open(path);
+        return is.isOpen() && data.read(is);
+    }
+
+    const CheckpointData& sections() const { return data; }
+
+    template <typename DUT>
+    void restore_dut(DUT& dut) {
+        is >> dut;
+        is.close();
+    }
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// =============================================================================
+// Edge-elision clocking
+//
+// Both DUTs only react to posedge clk (and async reset), so the falling-edge
+// eval() of a two-edge tick never changes anything. EdgeClock evaluates the
+// rising edge only: after lowering clk it clears the model's record of the
+// previous clk value itself, which is all the skipped eval() would have
+// changed, so the next rising edge is still seen as one. That record is a
+// Verilator internal, found by name at compile time (the testbench must
+// include the Verilated root header); if it is not found, the falling edge
+// is evaluated as before.
+//
+// Inputs changed between edges are picked up by the next rising-edge eval();
+// settle() is only needed when outputs are read before that, or for an
+// asynchronous input such as reset.
+//
+//   elide     rising edge only (the default)
+//   two-edge  the original eval() on both edges
+//   check     both edges, and every cycle verifies that the falling edge
+//             left the outputs unchanged and that the clk record holds what
+//             the elided path assumes (1 after the rising edge, 0 after the
+//             falling one)
+// =============================================================================
+enum ClockMode { CLOCK_ELIDE, CLOCK_TWO_EDGE, CLOCK_CHECK };
+
+// "elide"/"two-edge"/"check"; -1 if not recognized
+inline int parse_clock_mode(const char* s) {
+    if (strcmp(s, "elide") == 0) return CLOCK_ELIDE;
+    if (strcmp(s, "two-edge") == 0) return CLOCK_TWO_EDGE;
+    if (strcmp(s, "check") == 0) return CLOCK_CHECK;
+    return -1;
+}
+
+inline const char* clock_mode_name(ClockMode m) {
+    return m == CLOCK_ELIDE ? "elide" : m == CLOCK_TWO_EDGE ? "two-edge" : "check";
+}
+
+namespace clocking_detail {
+
+// Overloads are tried newest Verilator first
+template <int N> struct Priority : Priority<N - 1> {};
+template <> struct Priority<0> {};
+
+// Verilator 5.012+
+template <typename Root>
+auto last_clk(Root* r, Priority<3>) -> decltype(&r->__Vtrigprevexpr___TOP__clk__0) {
+    return &r->__Vtrigprevexpr___TOP__clk__0;
+}
+// Verilator 5.000 - 5.010
+template <typename Root>
+auto last_clk(Root* r, Priority<2>) -> decltype(&r->__Vtrigrprev__TOP__clk) {
+    return &r->__Vtrigrprev__TOP__clk;
+}
+// Verilator 4.210+
+template <typename Root>
+auto last_clk(Root* r, Priority<1>) -> decltype(&r->__Vclklast__TOP__clk) {
+    return &r->__Vclklast__TOP__clk;
+}
+template <typename Root>
+std::nullptr_t last_clk(Root*, Priority<0>) {
+    return nullptr;
+}
+
+template <typename DUT>
+auto find_last_clk(DUT* dut, Priority<1>) -> decltype(last_clk(dut->rootp, Priority<3>())) {
+    return last_clk(dut->rootp, Priority<3>());
+}
+template <typename DUT>
+std::nullptr_t find_last_clk(DUT*, Priority<0>) {
+    return nullptr;
+}
+
+}  // namespace clocking_detail
+
+template <typename DUT>
+class EdgeClock {
+private:
+    DUT* dut;
+    ClockMode mode;
+    uint8_t* last_clk;                  // NULL if this Verilator's layout is unknown
+    uint64_t (*outputs)(const DUT*);    // check mode: fingerprint of every output
+    uint64_t evals;
+
+public:
+    // Whether this DUT's clk edge state was found, i.e. elision is possible
+    static constexpr bool can_elide() {
+        return !std::is_same<decltype(clocking_detail::find_last_clk(
+                                 (DUT*)nullptr, clocking_detail::Priority<1>())),
+                             std::nullptr_t>::value;
+    }
+
+    EdgeClock(DUT* d, ClockMode m, uint64_t (*out)(const DUT*) = nullptr) :
+        dut(d), mode(m), last_clk(clocking_detail::find_last_clk(d, clocking_detail::Priority<1>())),
+        outputs(out), evals(0) {}
+
+    // True if falling edges are actually skipped
+    bool elides() const { return mode == CLOCK_ELIDE && last_clk; }
+    ClockMode get_mode() const { return mode; }
+    uint64_t get_evals() const { return evals; }
+
+    // One clock cycle, leaving clk low. Returns false (check mode only) if
+    // the falling edge was not the no-op the elided path takes it to be.
+    bool tick() {
+        dut->clk = 1;
+        dut->eval();
+        evals++;
+        dut->clk = 0;
+        if (elides()) {
+            *last_clk = 0;
+            return true;
+        }
+        if (mode != CLOCK_CHECK) {
+            dut->eval();
+            evals++;
+            return true;
+        }
+
+        bool ok = !last_clk || *last_clk == 1;
+        uint64_t before = outputs ? outputs(dut) : 0;
+        dut->eval();
+        evals++;
+        ok = ok && (!last_clk || *last_clk == 0);
+        return ok && (!outputs || outputs(dut) == before);
+    }
+
+    // Propagate input changes to the outputs without a clock edge
+    void settle() {
+        dut->eval();
+        evals++;
+    }
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+
+// =============================================================================
+// Counter reference model - the functions the counter testbench and benchmark
+// call, backed by the Zig model (counter_model.zig) or, with -DTB_MODEL_CPP
+// (make MODEL_BACKEND=cpp), by CounterRef below, which the compiler can inline
+// =============================================================================
+
+// C++ twin of counter_model.zig: one rising edge per tick()
+class CounterRef {
+private:
+    uint8_t count_ = 0;
+    bool rst_n = false;
+    bool enable = false;
+
+public:
+    constexpr void init() { *this = CounterRef(); }
+    constexpr void tick() {
+        if (!rst_n) {
+            count_ = 0;
+        } else if (enable) {
+            count_ = (uint8_t)(count_ + 1);   // wraps from 255 to 0
+        }
+    }
+    constexpr void set_reset(bool v) { rst_n = v; }
+    constexpr void set_enable(bool v) { enable = v; }
+    constexpr uint8_t count() const { return count_; }
+};
+
+// Reset holds the count at 0, enable counts, 256 cycles wrap back around
+constexpr bool counter_ref_check() {
+    CounterRef c;
+    c.set_enable(true);
+    c.tick();
+    if (c.count() != 0) return false;
+    c.set_reset(true);
+    for (int i = 0; i < 300; i++) c.tick();
+    if (c.count() != 300 - 256) return false;
+    c.set_enable(false);
+    c.tick();
+    return c.count() == 300 - 256;
+}
+static_assert(counter_ref_check(), "CounterRef: reset, enable and wraparound");
+
+#ifdef TB_MODEL_CPP
+// Reference model the testbench was built with, for its banner
+const char* const COUNTER_MODEL_NAME = "C++ (CounterRef)";
+
+// One global model, like the Zig one
+inline CounterRef counter_ref_model;
+
+inline void counter_init() { counter_ref_model.init(); }
+inline void counter_tick() { counter_ref_model.tick(); }
+inline void counter_set_reset(bool rst_n) { counter_ref_model.set_reset(rst_n); }
+inline void counter_set_enable(bool enable) { counter_ref_model.set_enable(enable); }
+inline unsigned char counter_get_count() { return counter_ref_model.count(); }
+#else
+const char* const COUNTER_MODEL_NAME = "Zig";
+
+// Zig reference model functions (compiled from counter_model.zig)
+extern "C" {
+    void counter_init();
+    void counter_tick();
+    void counter_set_reset(bool rst_n);
+    void counter_set_enable(bool enable);
+    unsigned char counter_get_count();
+}
+#endif
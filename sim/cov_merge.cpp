@@ -0,0 +1,48 @@
+// Merge coverage databases written by the testbenches (--cov-out) and report
+// the combined coverage, so closure over a whole regression can be checked
+// without re-running anything or parsing logs.
+//
+// usage: cov_merge [-o merged.cdb] run1.cdb run2.cdb ...
+#include <stdio.h>
+#include <string.h>
+#include "coverage.h"
+
+int main(int argc, char** argv) {
+    const char* out_path = NULL;
+    CoverGroup merged;
+    int inputs = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+            continue;
+        }
+
+        CoverGroup db;
+        if (!db.load(argv[i])) {
+            fprintf(stderr, "cov_merge: cannot read coverage database %s\n", argv[i]);
+            return 1;
+        }
+        if (inputs == 0) {
+            merged = db;
+        } else if (!merged.merge(db)) {
+            fprintf(stderr, "cov_merge: %s has a different covergroup layout\n", argv[i]);
+            return 1;
+        }
+        inputs++;
+    }
+
+    if (inputs == 0) {
+        fprintf(stderr, "usage: cov_merge [-o merged.cdb] run1.cdb run2.cdb ...\n");
+        return 1;
+    }
+
+    printf("Merged %d coverage databases\n", inputs);
+    merged.print_report();
+
+    if (out_path && !merged.save(out_path)) {
+        fprintf(stderr, "cov_merge: cannot write %s\n", out_path);
+        return 1;
+    }
+    return 0;
+}
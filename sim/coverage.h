@@ -0,0 +1,423 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// =============================================================================
+// Functional coverage engine - covergroups built from coverpoints and crosses
+//
+// Every bin of every coverpoint and cross is laid out in one flat index space
+// backed by a dense hit bitset and a 64-bit counter per bin. sample() turns
+// each value into a bin index through a lookup table (no per-bin compares),
+// so its cost does not depend on how the bins were declared. A group can be
+// written to a small self-describing binary file and merged with groups from
+// other seeds or processes by adding counters.
+// =============================================================================
+
+// Pass as a coverpoint value to leave that coverpoint unsampled this time
+const uint32_t COVER_NO_SAMPLE = UINT32_MAX;
+
+struct CoverBin {
+    std::string name;
+    uint32_t lo;
+    uint32_t hi;   // inclusive
+};
+
+// One bin per value in [lo, hi]
+inline std::vector<CoverBin> cover_bins_each(uint32_t lo, uint32_t hi) {
+    std::vector<CoverBin> bins;
+    for (uint32_t v = lo; v <= hi; v++) {
+        bins.push_back(CoverBin{std::to_string(v), v, v});
+    }
+    return bins;
+}
+
+// Bins over [0, max]: one per value while that fits in max_bins, otherwise
+// 0, 1, max-1 and max get their own bin and the middle is split evenly
+inline std::vector<CoverBin> cover_bins_auto(uint32_t max, uint32_t max_bins) {
+    if (max + 1 <= max_bins || max < 4) return cover_bins_each(0, max);
+
+    std::vector<CoverBin> bins = cover_bins_each(0, 1);
+    uint32_t lo = 2, hi = max - 2;
+    uint32_t ranges = max_bins > 4 ? max_bins - 4 : 1;
+    uint64_t span = (uint64_t)hi - lo + 1;
+    for (uint32_t r = 0; r < ranges && lo <= hi; r++) {
+        uint32_t end = lo + (uint32_t)((span + ranges - 1) / ranges) - 1;
+        if (end > hi) end = hi;
+        bins.push_back(CoverBin{std::to_string(lo) + ".." + std::to_string(end), lo, end});
+        lo = end + 1;
+    }
+    bins.push_back(CoverBin{std::to_string(max - 1), max - 1, max - 1});
+    bins.push_back(CoverBin{std::to_string(max), max, max});
+    return bins;
+}
+
+class CoverGroup {
+private:
+    struct Item {
+        std::string name;
+        bool is_cross;
+        uint32_t offset;                     // first bin in the flat index space
+        std::vector<std::string> bin_names;
+
+        // Coverpoint: value -> local bin, last entry catches everything else
+        std::vector<uint32_t> lut;
+        // Cross: operand items, their sampling slots, operand pair -> local
+        // bin (UINT32_MAX if ignored) and the (local, local) -> flat bin table
+        int a, b;
+        int slot_a, slot_b;
+        std::vector<uint32_t> pair_bin;
+        std::vector<uint32_t> cross_lut;
+
+        uint32_t num_bins() const { return (uint32_t)bin_names.size(); }
+    };
+
+    static const uint32_t FILE_MAGIC = 0x42444346;   // "FCDB"
+    static const uint32_t FILE_VERSION = 1;
+
+    std::string group_name;
+    std::vector<Item> items;
+    std::vector<int> points;           // coverpoint items, in sampling order
+    std::vector<int> crosses;          // cross items
+    std::vector<std::vector<uint32_t> > point_flat;   // per point: local bin -> flat bin
+    std::vector<uint64_t> counts;      // one per bin, plus a trailing sink
+    std::vector<uint64_t> hit_bits;
+    std::vector<uint32_t> local;       // scratch for sample()
+    uint64_t samples;
+    uint64_t version;                  // see hit_version()
+    bool sealed;
+
+    uint32_t total_bins() const {
+        return items.empty() ? 0 : items.back().offset + items.back().num_bins();
+    }
+
+    // Size the storage and build the flat lookup tables; done once, on first use
+    void seal() {
+        uint32_t sink = total_bins();
+        counts.assign(sink + 1, 0);
+        hit_bits.assign(sink / 64 + 1, 0);
+        local.assign(points.size(), 0);
+
+        point_flat.clear();
+        for (int p : points) {
+            const Item& it = items[p];
+            std::vector<uint32_t> flat(it.num_bins() + 1, sink);
+            for (uint32_t l = 0; l < it.num_bins(); l++) flat[l] = it.offset + l;
+            point_flat.push_back(flat);
+        }
+
+        for (int c : crosses) {
+            Item& it = items[c];
+            it.slot_a = point_slot(it.a);
+            it.slot_b = point_slot(it.b);
+            uint32_t na = items[it.a].num_bins(), nb = items[it.b].num_bins();
+            it.cross_lut.assign((na + 1) * (nb + 1), sink);
+            for (uint32_t la = 0; la < na; la++) {
+                for (uint32_t lb = 0; lb < nb; lb++) {
+                    uint32_t l = it.pair_bin[la * nb + lb];
+                    if (l != UINT32_MAX) it.cross_lut[la * (nb + 1) + lb] = it.offset + l;
+                }
+            }
+        }
+        sealed = true;
+    }
+
+    void hit(uint32_t bin) {
+        uint64_t& word = hit_bits[bin >> 6];
+        uint64_t mask = 1ull << (bin & 63);
+        counts[bin]++;
+        version += (word & mask) == 0;
+        word |= mask;
+    }
+
+    int point_slot(int item) const {
+        for (size_t p = 0; p < points.size(); p++) {
+            if (points[p] == item) return (int)p;
+        }
+        return -1;
+    }
+
+public:
+    explicit CoverGroup(const char* name = "") :
+        group_name(name), samples(0), version(0), sealed(false) {}
+
+    // ---- Declaration (before the first sample) ----------------------------
+
+    // Values in [0, domain) map to the bins whose range holds them; values
+    // outside every bin (or >= domain) are ignored. Returns the item id.
+    int coverpoint(const char* name, uint32_t domain, const std::vector<CoverBin>& bins) {
+        Item it;
+        it.name = name;
+        it.is_cross = false;
+        it.offset = total_bins();
+        it.a = it.b = it.slot_a = it.slot_b = -1;
+        it.lut.assign((size_t)domain + 1, (uint32_t)bins.size());
+        for (size_t i = 0; i < bins.size(); i++) {
+            it.bin_names.push_back(bins[i].name);
+            for (uint64_t v = bins[i].lo; v <= bins[i].hi && v < domain; v++) {
+                it.lut[v] = (uint32_t)i;
+            }
+        }
+        items.push_back(it);
+        points.push_back((int)items.size() - 1);
+        sealed = false;
+        return (int)items.size() - 1;
+    }
+
+    // Every pairing of a bin of coverpoint a with a bin of coverpoint b,
+    // except the (bin_a, bin_b) pairs listed in ignore (unreachable combinations)
+    int cross(const char* name, int a, int b,
+              const std::vector<std::pair<uint32_t, uint32_t> >& ignore = {}) {
+        Item it;
+        it.name = name;
+        it.is_cross = true;
+        it.offset = total_bins();
+        it.a = a;
+        it.b = b;
+        it.slot_a = it.slot_b = -1;
+        uint32_t na = items[a].num_bins(), nb = items[b].num_bins();
+        it.pair_bin.assign(na * nb, 0);
+        for (const auto& p : ignore) it.pair_bin[p.first * nb + p.second] = UINT32_MAX;
+        for (uint32_t la = 0; la < na; la++) {
+            for (uint32_t lb = 0; lb < nb; lb++) {
+                uint32_t& l = it.pair_bin[la * nb + lb];
+                if (l == UINT32_MAX) continue;
+                l = it.num_bins();
+                it.bin_names.push_back(items[a].bin_names[la] + " x " + items[b].bin_names[lb]);
+            }
+        }
+        items.push_back(it);
+        crosses.push_back((int)items.size() - 1);
+        sealed = false;
+        return (int)items.size() - 1;
+    }
+
+    // ---- Sampling ---------------------------------------------------------
+
+    // values[] holds one value per coverpoint, in declaration order
+    void sample(const uint32_t* values) {
+        if (!sealed) seal();
+        for (size_t p = 0; p < points.size(); p++) {
+            const Item& it = items[points[p]];
+            uint32_t last = (uint32_t)it.lut.size() - 1;
+            uint32_t v = values[p] < last ? values[p] : last;
+            local[p] = it.lut[v];
+            hit(point_flat[p][local[p]]);
+        }
+        for (int c : crosses) {
+            const Item& it = items[c];
+            uint32_t nb = items[it.b].num_bins();
+            hit(it.cross_lut[local[it.slot_a] * (nb + 1) + local[it.slot_b]]);
+        }
+        samples++;
+    }
+
+    // Sample a single coverpoint on its own (crosses are not updated)
+    void sample_point(int item, uint32_t value) {
+        if (!sealed) seal();
+        int p = point_slot(item);
+        const Item& it = items[item];
+        uint32_t last = (uint32_t)it.lut.size() - 1;
+        hit(point_flat[p][it.lut[value < last ? value : last]]);
+    }
+
+    // ---- Queries ----------------------------------------------------------
+
+    int num_items() const { return (int)items.size(); }
+    const char* item_name(int item) const { return items[item].name.c_str(); }
+    uint32_t num_bins(int item) const { return items[item].num_bins(); }
+    const char* bin_name(int item, uint32_t bin) const { return items[item].bin_names[bin].c_str(); }
+
+    uint64_t bin_count(int item, uint32_t bin) const {
+        return sealed ? counts[items[item].offset + bin] : 0;
+    }
+    bool is_hit(int item, uint32_t bin) const {
+        if (!sealed || bin >= num_bins(item)) return false;
+        uint32_t i = items[item].offset + bin;
+        return (hit_bits[i >> 6] >> (i & 63)) & 1;
+    }
+
+    // Local bin index of a cross bin from its operand bins (UINT32_MAX if ignored)
+    uint32_t cross_bin(int item, uint32_t bin_a, uint32_t bin_b) const {
+        return items[item].pair_bin[bin_a * items[items[item].b].num_bins() + bin_b];
+    }
+
+    uint32_t hit_bins(int item) const {
+        uint32_t n = 0;
+        for (uint32_t b = 0; b < num_bins(item); b++) n += is_hit(item, b);
+        return n;
+    }
+
+    double item_coverage(int item) const {
+        return num_bins(item) ? 100.0 * hit_bins(item) / num_bins(item) : 100.0;
+    }
+
+    // Every coverpoint and cross weighted equally
+    double coverage() const {
+        if (items.empty()) return 0.0;
+        double sum = 0;
+        for (int i = 0; i < num_items(); i++) sum += item_coverage(i);
+        return sum / items.size();
+    }
+
+    uint64_t get_samples() const { return samples; }
+
+    // Changes whenever a bin is hit for the first time (or groups are merged
+    // or loaded), so anything derived from the hit set, like coverage(), only
+    // needs recomputing when this moves
+    uint64_t hit_version() const { return version; }
+
+    // ---- Merging and persistence ------------------------------------------
+
+    // Same items, in the same order, with the same bins
+    bool same_layout(const CoverGroup& other) const {
+        if (items.size() != other.items.size()) return false;
+        for (size_t i = 0; i < items.size(); i++) {
+            if (items[i].name != other.items[i].name ||
+                items[i].is_cross != other.items[i].is_cross ||
+                items[i].bin_names != other.items[i].bin_names) return false;
+        }
+        return true;
+    }
+
+    // Add another group's counters into this one; false if layouts differ
+    bool merge(const CoverGroup& other) {
+        if (!same_layout(other)) return false;
+        if (!sealed) seal();
+        if (!other.sealed) return true;
+        for (size_t i = 0; i < counts.size(); i++) counts[i] += other.counts[i];
+        for (size_t i = 0; i < hit_bits.size(); i++) hit_bits[i] |= other.hit_bits[i];
+        samples += other.samples;
+        version++;
+        return true;
+    }
+
+    // Checkpointing: the sample count and one counter per bin. Unlike load(),
+    // restoring needs a group declared with the same coverpoints and crosses
+    // and leaves it sampleable.
+    void save_state(std::vector<uint64_t>& out) {
+        if (!sealed) seal();
+        out.assign(1, samples);
+        out.insert(out.end(), counts.begin(), counts.begin() + total_bins());
+    }
+    bool restore_state(const std::vector<uint64_t>& in) {
+        if (!sealed) seal();
+        uint32_t n = total_bins();
+        if (in.size() != 1 + (size_t)n) return false;
+        samples = in[0];
+        for (uint32_t i = 0; i < n; i++) {
+            counts[i] = in[1 + i];
+            if (counts[i]) {
+                hit_bits[i >> 6] |= 1ull << (i & 63);
+            } else {
+                hit_bits[i >> 6] &= ~(1ull << (i & 63));
+            }
+        }
+        version++;
+        return true;
+    }
+
+    // Layout followed by one counter per bin. Loaded groups can be merged,
+    // queried and saved again, but not sampled. The stream versions read and
+    // write a database embedded in a larger file (see result_file.h).
+    bool save(const char* path) {
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        bool ok = save(f);
+        return fclose(f) == 0 && ok;
+    }
+
+    bool load(const char* path) {
+        FILE* f = fopen(path, "rb");
+        if (!f) return false;
+        bool ok = load(f);
+        fclose(f);
+        return ok;
+    }
+
+    bool save(FILE* f) {
+        if (!sealed) seal();
+        auto put_u32 = [f](uint32_t v) { fwrite(&v, sizeof(v), 1, f); };
+        auto put_str = [f, &put_u32](const std::string& s) {
+            put_u32((uint32_t)s.size());
+            fwrite(s.data(), 1, s.size(), f);
+        };
+
+        put_u32(FILE_MAGIC);
+        put_u32(FILE_VERSION);
+        put_str(group_name);
+        fwrite(&samples, sizeof(samples), 1, f);
+        put_u32((uint32_t)items.size());
+        for (const Item& it : items) {
+            put_str(it.name);
+            put_u32(it.is_cross);
+            put_u32(it.num_bins());
+            for (const std::string& b : it.bin_names) put_str(b);
+        }
+        fwrite(counts.data(), sizeof(uint64_t), total_bins(), f);
+        return !ferror(f);
+    }
+
+    bool load(FILE* f) {
+        bool ok = true;
+        auto get_u32 = [f, &ok]() {
+            uint32_t v = 0;
+            if (fread(&v, sizeof(v), 1, f) != 1) ok = false;
+            return v;
+        };
+        auto get_str = [f, &ok, &get_u32]() {
+            uint32_t n = get_u32();
+            std::string s(ok ? n : 0, '\0');
+            if (ok && n && fread(&s[0], 1, n, f) != n) ok = false;
+            return s;
+        };
+
+        if (get_u32() != FILE_MAGIC || get_u32() != FILE_VERSION) return false;
+        group_name = get_str();
+        if (fread(&samples, sizeof(samples), 1, f) != 1) ok = false;
+
+        items.clear();
+        points.clear();
+        crosses.clear();
+        uint32_t n_items = get_u32();
+        for (uint32_t i = 0; ok && i < n_items; i++) {
+            Item it;
+            it.name = get_str();
+            it.is_cross = get_u32() != 0;
+            it.offset = total_bins();
+            it.a = it.b = it.slot_a = it.slot_b = -1;
+            uint32_t n_bins = get_u32();
+            for (uint32_t b = 0; ok && b < n_bins; b++) it.bin_names.push_back(get_str());
+            items.push_back(it);
+        }
+
+        uint32_t sink = total_bins();
+        counts.assign(sink + 1, 0);
+        hit_bits.assign(sink / 64 + 1, 0);
+        if (ok && fread(counts.data(), sizeof(uint64_t), sink, f) != sink) ok = false;
+
+        for (uint32_t i = 0; i < sink; i++) {
+            if (counts[i]) hit_bits[i >> 6] |= 1ull << (i & 63);
+        }
+        version++;
+        sealed = true;
+        return ok;
+    }
+
+    // Per-item coverage, listing the bins still missing
+    void print_report() const {
+        printf("\nCovergroup %s: %.1f%% (%llu samples)\n", group_name.c_str(), coverage(),
+               (unsigned long long)samples);
+        for (int i = 0; i < num_items(); i++) {
+            printf("  %-8s %-22s %u/%u bins (%.1f%%)\n", items[i].is_cross ? "cross" : "point",
+                   item_name(i), hit_bins(i), num_bins(i), item_coverage(i));
+            for (uint32_t b = 0; b < num_bins(i); b++) {
+                if (!is_hit(i, b)) printf("      MISS %s\n", bin_name(i, b));
+            }
+        }
+    }
+};
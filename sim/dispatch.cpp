@@ -0,0 +1,589 @@
+// Multi-node FIFO regression. The dispatcher splits a seed space over a matrix
+// of FIFO configurations and build profiles into work units of SHARD seeds,
+// hands them to workers through a job queue (job_queue.h) and merges the
+// result records the testbench runs send back (tb_fifo --result, see
+// result_file.h) into one report. Workers run on any host that sees the
+// queue directory and a built checkout, so adding hosts adds throughput; the
+// dispatcher retries units whose worker failed or went silent, duplicates
+// stragglers once nothing is left to hand out, and takes the first result of
+// every unit.
+//
+// usage:
+//   dispatch run    --queue DIR [--configs 8x8,16x32,...] [--profiles default,fast,...]
+//                   [--seeds N] [--seed S] [--shard K] [--args "TB ARGS"] [--local W]
+//                   [--jobs J] [--retries R] [--timeout SEC] [--straggler F]
+//                   [--root DIR] [--no-build] [--summary FILE] [--cov-dir DIR]
+//   dispatch worker --queue DIR [--root DIR] [--name NAME] [--jobs J] [--build]
+//   dispatch report --queue DIR [--root DIR] [--summary FILE] [--cov-dir DIR]
+//
+// run builds every binary of the matrix (make build_fifo_CONFIG PROFILE=P),
+// queues the units, starts W local workers if asked and waits for the results;
+// workers started anywhere else with the same --queue join in. A worker exits
+// once the dispatcher has closed the queue and nothing is left to claim.
+// report prints the merged report of whatever results are in a queue.
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "job_queue.h"
+#include "result_file.h"
+#include "tb_log.h"
+
+static const char* const PROFILES[] = {"default", "debug", "fast", "max"};
+
+// Value of "--name TEXT" on the command line, or fallback if absent
+const char* arg_str(int argc, char** argv, const char* name, const char* fallback) {
+    for (int i = 2; i + 1 < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return argv[i + 1];
+    }
+    return fallback;
+}
+
+int arg_int(int argc, char** argv, const char* name, int fallback) {
+    const char* v = arg_str(argc, argv, name, NULL);
+    return v ? atoi(v) : fallback;
+}
+
+// Whether "--name" is on the command line
+bool arg_flag(int argc, char** argv, const char* name) {
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t end = s.find(sep, start);
+        if (end == std::string::npos) end = s.size();
+        if (end > start) parts.push_back(s.substr(start, end - start));
+        start = end + 1;
+    }
+    return parts;
+}
+
+// "a,b,c" or "a b c"
+std::vector<std::string> list_arg(int argc, char** argv, const char* name, const char* fallback) {
+    std::string s = arg_str(argc, argv, name, fallback);
+    std::replace(s.begin(), s.end(), ' ', ',');
+    return split(s, ',');
+}
+
+// Obj dir of a configuration and profile, as the Makefile names it
+std::string fifo_binary(const std::string& root, const WorkUnit& u) {
+    std::string dir = "sim/obj_dir_fifo_" + u.config + (u.profile == "default" ? "" : "_" + u.profile);
+    return (root.empty() || root == "." ? "" : root + "/") + dir + "/Vfifo";
+}
+
+bool make_fifo(const std::string& root, const std::vector<std::string>& configs, const std::string& profile,
+               const char* log) {
+    std::string cmd = "make -C '" + root + "' --no-print-directory -j PROFILE=" + profile;
+    for (const std::string& c : configs) cmd += " build_fifo_" + c;
+    if (log) cmd += std::string(" >>'") + log + "' 2>&1";
+    return system(cmd.c_str()) == 0;
+}
+
+// =============================================================================
+// Worker
+// =============================================================================
+static volatile sig_atomic_t worker_stop = 0;
+static void on_stop(int) { worker_stop = 1; }
+
+const double HEARTBEAT_SECONDS = 5;
+
+struct WorkerOptions {
+    std::string queue;
+    std::string root;
+    std::string name;
+    int jobs;
+    bool build;   // build missing binaries here (hosts with a checkout of their own)
+};
+
+// Run one unit's testbench; true if it produced a result
+bool run_unit(JobQueue& q, const WorkerOptions& opts, const WorkUnit& u, std::set<std::string>& built) {
+    std::string res = q.scratch_path(u, ".res");
+    std::string log = q.scratch_path(u, ".log");
+    std::string bin = fifo_binary(opts.root, u);
+    unlink(res.c_str());
+
+    if (opts.build && !built.count(u.config + " " + u.profile)) {
+        // Local workers share a checkout: one build at a time
+        std::string lock = opts.root + "/sim/.dispatch_build.lock";
+        int fd = open(lock.c_str(), O_CREAT | O_RDWR, 0666);
+        if (fd >= 0) flock(fd, LOCK_EX);
+        bool ok = make_fifo(opts.root, {u.config}, u.profile, log.c_str());
+        if (fd >= 0) close(fd);
+        if (!ok) return false;
+        built.insert(u.config + " " + u.profile);
+    }
+
+    std::vector<std::string> args = {bin, "--seed", std::to_string(u.first_seed), "--seeds",
+                                     std::to_string(u.seeds), "--jobs", std::to_string(opts.jobs),
+                                     "--log-level", "error", "--result", res};
+    for (const std::string& a : split(u.args, ' ')) args.push_back(a);
+
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0666);
+        if (fd >= 0) {
+            dup2(fd, 1);
+            dup2(fd, 2);
+        }
+        std::vector<char*> cargs;
+        for (std::string& a : args) cargs.push_back(&a[0]);
+        cargs.push_back(NULL);
+        execv(cargs[0], cargs.data());
+        fprintf(stderr, "dispatch: cannot run %s: %s\n", cargs[0], strerror(errno));
+        _exit(127);
+    }
+
+    int status = 0;
+    double beat = wall_seconds();
+    while (waitpid(pid, &status, WNOHANG) == 0) {
+        if (worker_stop) {
+            kill(pid, SIGTERM);
+            waitpid(pid, &status, 0);
+            return false;
+        }
+        if (wall_seconds() - beat >= HEARTBEAT_SECONDS) {
+            q.heartbeat(u);
+            beat = wall_seconds();
+        }
+        usleep(100000);
+    }
+
+    // 0 (passed) and 1 (failing seeds) both leave a result
+    RunResult r;
+    const char* error = NULL;
+    bool exited = WIFEXITED(status) && WEXITSTATUS(status) <= 1;
+    if (!exited || !r.read(res.c_str(), &error)) {
+        printf("[WORKER %s] %s: no result (%s, see %s)\n", opts.name.c_str(), u.id.c_str(),
+               !exited ? "testbench crashed or could not run" : error, log.c_str());
+        return false;
+    }
+    size_t failing = 0;
+    for (const ResultSeed& s : r.seeds) failing += s.failed();
+    printf("[WORKER %s] %s: seeds %llu..%llu, %zu failing, %.1f s\n", opts.name.c_str(), u.id.c_str(),
+           (unsigned long long)u.first_seed, (unsigned long long)(u.first_seed + u.seeds - 1), failing,
+           r.seconds);
+    return true;
+}
+
+int run_worker(const WorkerOptions& opts) {
+    DirQueue q(opts.queue);
+    if (!q.create(false)) {
+        fprintf(stderr, "dispatch: cannot use queue %s\n", opts.queue.c_str());
+        return 1;
+    }
+    signal(SIGTERM, on_stop);
+    signal(SIGINT, on_stop);
+
+    std::set<std::string> built;
+    int units = 0;
+    while (!worker_stop) {
+        WorkUnit u;
+        if (q.claim(opts.name, &u)) {
+            fflush(stdout);
+            if (run_unit(q, opts, u, built)) {
+                q.finish(u);
+                units++;
+            } else if (!worker_stop) {
+                q.fail(u);
+            }
+            fflush(stdout);
+        } else if (q.closed()) {
+            break;
+        } else {
+            usleep(500000);
+        }
+    }
+    printf("[WORKER %s] %d units\n", opts.name.c_str(), units);
+    return 0;
+}
+
+std::string default_worker_name() {
+    char host[256] = "host";
+    gethostname(host, sizeof(host) - 1);
+    std::string name = std::string(host) + "." + std::to_string(getpid());
+    // Separators of the queue's file names
+    for (char& c : name) {
+        if (c == '@' || c == '~' || c == '/') c = '_';
+    }
+    return name;
+}
+
+// =============================================================================
+// Merged report
+// =============================================================================
+struct MatrixEntry {
+    RunResult result;
+    int units = 0;
+    int missing = 0;
+};
+
+// Report on every unit of the queue; true if they all have a passing result
+bool report(DirQueue& q, const std::string& root, const char* summary_path, const char* cov_dir,
+            double wall, size_t workers) {
+    std::vector<WorkUnit> units = q.units();
+    std::sort(units.begin(), units.end(), [](const WorkUnit& a, const WorkUnit& b) { return a.id < b.id; });
+
+    std::map<std::pair<std::string, std::string>, MatrixEntry> matrix;   // (config, profile)
+    std::vector<std::pair<WorkUnit, ResultSeed> > failing;
+    std::vector<std::string> missing;
+    uint64_t cycles = 0, mismatches = 0, latency_violations = 0, assertion_failures = 0;
+    double tb_seconds = 0;
+    size_t seeds = 0;
+
+    for (const WorkUnit& u : units) {
+        MatrixEntry& e = matrix[std::make_pair(u.config, u.profile)];
+        e.units++;
+        RunResult r;
+        const char* error = NULL;
+        if (!r.read(q.result_path(u.id).c_str(), &error)) {
+            e.missing++;
+            missing.push_back(u.id);
+            continue;
+        }
+        if (!e.result.merge(r)) {
+            printf("[DISPATCH] %s: result does not match the other %s %s results\n", u.id.c_str(),
+                   u.config.c_str(), u.profile.c_str());
+            e.missing++;
+            missing.push_back(u.id);
+            continue;
+        }
+        tb_seconds += r.seconds;
+        for (const ResultSeed& s : r.seeds) {
+            seeds++;
+            cycles += s.cycles;
+            mismatches += s.mismatches;
+            latency_violations += s.latency_violations;
+            assertion_failures += s.assertion_failures;
+            if (s.failed()) failing.push_back(std::make_pair(u, s));
+        }
+    }
+
+    printf("\n========================================\n");
+    printf("Regression: %zu units, %zu seeds, %zu configurations x profiles\n", units.size(), seeds,
+           matrix.size());
+    if (wall > 0) {
+        printf("  %zu workers, %.1f s wall, %.1f s of testbench runs (%.1fx)\n", workers, wall, tb_seconds,
+               tb_seconds / wall);
+    }
+    printf("========================================\n");
+    printf("%-9s %-8s %7s %7s %9s %16s %9s\n", "Config", "Profile", "Seeds", "Failed", "Asserts",
+           "Lat p50/p99/max", "Coverage");
+    for (auto& kv : matrix) {
+        const RunResult& r = kv.second.result;
+        size_t failed = 0;
+        uint64_t asserts = 0;
+        for (const ResultSeed& s : r.seeds) {
+            failed += s.failed();
+            asserts += s.assertion_failures;
+        }
+        char lat[48];
+        snprintf(lat, sizeof(lat), "%llu/%llu/%llu", (unsigned long long)r.latency.percentile(0.50),
+                 (unsigned long long)r.latency.percentile(0.99), (unsigned long long)r.latency.get_max());
+        printf("%-9s %-8s %7zu %7zu %9llu %16s %8.1f%%", kv.first.first.c_str(), kv.first.second.c_str(),
+               r.seeds.size(), failed, (unsigned long long)asserts, lat, r.coverage.coverage());
+        if (kv.second.missing) printf("  (%d of %d units missing)", kv.second.missing, kv.second.units);
+        printf("\n");
+
+        if (cov_dir && kv.second.missing < kv.second.units) {
+            std::string cdb = std::string(cov_dir) + "/" + kv.first.first + "_" + kv.first.second + ".cdb";
+            if (!kv.second.result.coverage.save(cdb.c_str())) {
+                printf("[DISPATCH] cannot write %s\n", cdb.c_str());
+            }
+        }
+    }
+
+    if (!failing.empty()) {
+        printf("\nFailing seeds (%zu):\n", failing.size());
+        for (size_t i = 0; i < failing.size() && i < 20; i++) {
+            const WorkUnit& u = failing[i].first;
+            const ResultSeed& s = failing[i].second;
+            printf("  %s %s seed %llu: %u mismatches, %u latency violations, %u assertion failures\n",
+                   u.config.c_str(), u.profile.c_str(), (unsigned long long)s.seed, s.mismatches,
+                   s.latency_violations, s.assertion_failures);
+            printf("    rerun: %s --seed %llu%s%s\n", fifo_binary(root, u).c_str(), (unsigned long long)s.seed,
+                   u.args.empty() ? "" : " ", u.args.c_str());
+        }
+        if (failing.size() > 20) printf("  ... and %zu more\n", failing.size() - 20);
+    }
+    if (!missing.empty()) {
+        printf("\nUnits without a result (%zu), logs in the queue's work/ directory:\n", missing.size());
+        for (const std::string& id : missing) printf("  %s\n", id.c_str());
+    }
+
+    bool passed = !units.empty() && failing.empty() && missing.empty();
+    printf("\n%s\n", passed ? "*** REGRESSION PASSED ***" : "*** REGRESSION FAILED ***");
+
+    if (summary_path) {
+        RunSummary sum;
+        std::vector<uint64_t> failed_seeds;
+        for (auto& f : failing) failed_seeds.push_back(f.second.seed);
+        sum.add("units", units.size());
+        sum.add("missing_units", missing.size());
+        sum.add("seeds", seeds);
+        sum.add("failed_seeds", failed_seeds);
+        sum.add("cycles", cycles);
+        sum.add("mismatches", mismatches);
+        sum.add("latency_violations", latency_violations);
+        sum.add("assertion_failures", assertion_failures);
+        sum.add("workers", workers);
+        sum.add("wall_seconds", wall);
+        sum.add("tb_seconds", tb_seconds);
+        sum.add("passed", passed);
+        if (!sum.write(summary_path)) printf("[DISPATCH] cannot write %s\n", summary_path);
+    }
+    return passed;
+}
+
+// =============================================================================
+// Dispatcher
+// =============================================================================
+struct DispatchOptions {
+    std::string queue;
+    std::string root;
+    std::vector<std::string> configs;
+    std::vector<std::string> profiles;
+    uint64_t first_seed;
+    uint64_t seeds;
+    uint32_t shard;
+    std::string args;
+    int local;
+    int jobs;
+    int retries;
+    double timeout;     // seconds without a heartbeat before a unit is requeued
+    double straggler;   // duplicate units running this many times the median
+    bool build;
+};
+
+// Median testbench time of the results so far
+double median(std::vector<double> v) {
+    if (v.empty()) return 0;
+    std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+    return v[v.size() / 2];
+}
+
+int run_dispatch(const DispatchOptions& opts, const char* summary_path, const char* cov_dir) {
+    for (const std::string& c : opts.configs) {
+        unsigned d, w;
+        char end;
+        if (sscanf(c.c_str(), "%ux%u%c", &d, &w, &end) != 2) {
+            fprintf(stderr, "dispatch: bad configuration %s (expected DEPTHxDATA_WIDTH)\n", c.c_str());
+            return 2;
+        }
+    }
+    for (const std::string& p : opts.profiles) {
+        if (std::find(std::begin(PROFILES), std::end(PROFILES), p) == std::end(PROFILES)) {
+            fprintf(stderr, "dispatch: unknown profile %s\n", p.c_str());
+            return 2;
+        }
+    }
+    if (opts.build) {
+        for (const std::string& p : opts.profiles) {
+            printf("[DISPATCH] Building %zu configurations (%s profile)...\n", opts.configs.size(), p.c_str());
+            fflush(stdout);
+            if (!make_fifo(opts.root, opts.configs, p, NULL)) {
+                fprintf(stderr, "dispatch: build failed\n");
+                return 1;
+            }
+        }
+    }
+
+    DirQueue q(opts.queue);
+    if (!q.create(true)) {
+        fprintf(stderr, "dispatch: cannot create queue %s\n", opts.queue.c_str());
+        return 1;
+    }
+    std::map<std::string, WorkUnit> queued;
+    std::set<std::string> open;   // units without a result that are not dead
+    for (const std::string& c : opts.configs) {
+        for (const std::string& p : opts.profiles) {
+            for (uint64_t s = 0; s < opts.seeds; s += opts.shard) {
+                char id[128];
+                snprintf(id, sizeof(id), "%s-%s-%04llu", c.c_str(), p.c_str(),
+                         (unsigned long long)(s / opts.shard));
+                WorkUnit u = {id, c, p, opts.first_seed + s,
+                              (uint32_t)std::min<uint64_t>(opts.shard, opts.seeds - s), opts.args, 0, ""};
+                if (!q.submit(u)) {
+                    fprintf(stderr, "dispatch: cannot queue %s\n", id);
+                    return 1;
+                }
+                queued[id] = u;
+                open.insert(id);
+            }
+        }
+    }
+    size_t total = open.size();
+    printf("[DISPATCH] %zu units of up to %u seeds queued in %s\n", total, opts.shard, opts.queue.c_str());
+    fflush(stdout);
+
+    std::vector<pid_t> local;
+    for (int i = 0; i < opts.local; i++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+            WorkerOptions w = {opts.queue, opts.root, default_worker_name() + "-" + std::to_string(i),
+                               opts.jobs, false};
+            _exit(run_worker(w));
+        }
+        if (pid > 0) local.push_back(pid);
+    }
+
+    double start = wall_seconds(), last_progress = start;
+    std::map<std::string, int> tickets;    // highest ticket issued per unit
+    std::map<std::string, int> attempts;   // failed or lost runs per unit
+    std::set<std::string> duplicated, dead, workers;
+    std::vector<double> durations;
+
+    while (!open.empty()) {
+        QueueSnapshot s;
+        q.snapshot(s);
+        double now = wall_seconds();
+
+        // A unit is retried until it has failed or been lost retries+1 times
+        auto retry = [&](const WorkUnit& u, const char* why) {
+            if (++attempts[u.id] > opts.retries) {
+                printf("[DISPATCH] %s: %s on %s, giving up after %d attempts\n", u.id.c_str(), why,
+                       u.worker.c_str(), attempts[u.id]);
+                q.abandon(u);
+                open.erase(u.id);
+                dead.insert(u.id);
+            } else {
+                printf("[DISPATCH] %s: %s on %s, requeued\n", u.id.c_str(), why, u.worker.c_str());
+                q.requeue(u, ++tickets[u.id]);
+            }
+        };
+        for (const std::string& id : s.done) {
+            if (!open.count(id)) continue;
+            RunResult r;
+            const char* error = NULL;
+            if (!r.read(q.result_path(id).c_str(), &error)) {
+                printf("[DISPATCH] %s: unreadable result (%s)\n", id.c_str(), error);
+                unlink(q.result_path(id).c_str());
+                WorkUnit u = queued[id];
+                u.ticket = ++tickets[id];
+                if (++attempts[id] > opts.retries) {
+                    open.erase(id);
+                    dead.insert(id);
+                } else {
+                    q.submit(u);
+                }
+                continue;
+            }
+            open.erase(id);
+            durations.push_back(r.seconds);
+            q.cancel(id);
+        }
+
+        for (const WorkUnit& u : s.failed) {
+            if (open.count(u.id)) {
+                retry(u, "no result");
+            } else {
+                q.abandon(u);   // a duplicate of a unit that is done
+            }
+        }
+
+        std::vector<double> running_for;
+        for (const RunningUnit& r : s.running) {
+            workers.insert(r.unit.worker);
+            if (!open.count(r.unit.id)) continue;
+            if (now - r.heartbeat > opts.timeout) {
+                retry(r.unit, "no heartbeat");
+                continue;
+            }
+            // Stragglers: once nothing is waiting, run slow units a second time
+            // elsewhere and take whichever result comes first
+            double m = median(durations);
+            if (s.pending.empty() && !duplicated.count(r.unit.id) && durations.size() >= 3 &&
+                now - r.claimed > opts.straggler * m && now - r.claimed > 5) {
+                WorkUnit dup = r.unit;
+                dup.ticket = ++tickets[r.unit.id];
+                dup.worker.clear();
+                if (q.submit(dup)) {
+                    duplicated.insert(r.unit.id);
+                    printf("[DISPATCH] %s: running %.0f s on %s (median %.1f s), duplicated\n", r.unit.id.c_str(),
+                           now - r.claimed, r.unit.worker.c_str(), m);
+                }
+            }
+        }
+
+        if (now - last_progress >= 10) {
+            printf("[DISPATCH] %zu/%zu units done, %zu running, %zu pending\n", total - open.size() - dead.size(),
+                   total, s.running.size(), s.pending.size());
+            last_progress = now;
+        }
+        fflush(stdout);
+        if (!open.empty()) usleep(250000);
+    }
+
+    // Workers elsewhere exit once nothing is left; local ones stop now
+    q.close();
+    for (pid_t pid : local) kill(pid, SIGTERM);
+    for (pid_t pid : local) waitpid(pid, NULL, 0);
+
+    bool passed = report(q, opts.root, summary_path, cov_dir, wall_seconds() - start, workers.size());
+    return passed ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    const char* cmd = argc > 1 ? argv[1] : "";
+    const char* queue = arg_str(argc, argv, "--queue", NULL);
+    std::string root = arg_str(argc, argv, "--root", ".");
+    const char* summary_path = arg_str(argc, argv, "--summary", NULL);
+    const char* cov_dir = arg_str(argc, argv, "--cov-dir", NULL);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (queue && strcmp(cmd, "run") == 0) {
+        DispatchOptions opts;
+        opts.queue = queue;
+        opts.root = root;
+        opts.configs = list_arg(argc, argv, "--configs", "8x8,16x8,16x32,64x16,1024x64");
+        opts.profiles = list_arg(argc, argv, "--profiles", "default");
+        opts.first_seed = strtoull(arg_str(argc, argv, "--seed", "1"), NULL, 0);
+        opts.seeds = strtoull(arg_str(argc, argv, "--seeds", "1000"), NULL, 0);
+        opts.shard = (uint32_t)std::max(1, arg_int(argc, argv, "--shard", 100));
+        opts.args = arg_str(argc, argv, "--args", "");
+        opts.local = arg_int(argc, argv, "--local", 0);
+        // Local workers split the cores between them
+        opts.jobs = arg_int(argc, argv, "--jobs", opts.local > 0 ? std::max(1L, cores / opts.local) : 0);
+        opts.retries = arg_int(argc, argv, "--retries", 2);
+        opts.timeout = atof(arg_str(argc, argv, "--timeout", "120"));
+        opts.straggler = atof(arg_str(argc, argv, "--straggler", "3"));
+        opts.build = !arg_flag(argc, argv, "--no-build");
+        return run_dispatch(opts, summary_path, cov_dir);
+    }
+    if (queue && strcmp(cmd, "worker") == 0) {
+        WorkerOptions opts = {queue, root, arg_str(argc, argv, "--name", default_worker_name().c_str()),
+                              arg_int(argc, argv, "--jobs", 0), arg_flag(argc, argv, "--build")};
+        return run_worker(opts);
+    }
+    if (queue && strcmp(cmd, "report") == 0) {
+        DirQueue q(queue);
+        return report(q, root, summary_path, cov_dir, 0, 0) ? 0 : 1;
+    }
+
+    fprintf(stderr,
+            "usage: %s run    --queue DIR [--configs 8x8,...] [--profiles default,...] [--seeds N]\n"
+            "                 [--seed S] [--shard K] [--args \"TB ARGS\"] [--local W] [--jobs J]\n"
+            "                 [--retries R] [--timeout SEC] [--straggler F] [--root DIR] [--no-build]\n"
+            "                 [--summary FILE] [--cov-dir DIR]\n"
+            "       %s worker --queue DIR [--root DIR] [--name NAME] [--jobs J] [--build]\n"
+            "       %s report --queue DIR [--root DIR] [--summary FILE] [--cov-dir DIR]\n",
+            argv[0], argv[0], argv[0]);
+    return 2;
+}
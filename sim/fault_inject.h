@@ -0,0 +1,212 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "fifo_model.h"
+#include "prng.h"
+
+// =============================================================================
+// Fault injection - single bit flips in the FIFO's registers
+//
+// A fault flips one bit of memory[i], wr_ptr, rd_ptr or count_reg of rtl/fifo.sv
+// just before the rising edge of a chosen cycle; tb_fifo --faults N then runs
+// the testbench's checkers on from there and records whether and how soon they
+// notice. The registers are reached by name in the Verilated model, which
+// takes a build with --public-flat-rw (make ... FAULTS=1): Verilator keeps
+// every signal under its flat name in the root module and treats a write from
+// the testbench as if it happened at the signal's own clock edge.
+//
+// A faulty run is compared against the golden one through a digest of the
+// register state after every edge, kept up to date in O(1) per cycle: the
+// FIFO only ever writes memory[wr_ptr], so that is the only entry to rehash.
+// =============================================================================
+
+enum FaultTarget { FAULT_MEMORY, FAULT_WR_PTR, FAULT_RD_PTR, FAULT_COUNT, FAULT_TARGETS };
+static const char* const FAULT_TARGET_NAMES[FAULT_TARGETS] = {"memory", "wr_ptr", "rd_ptr", "count_reg"};
+
+constexpr int fault_clog2(unsigned n) { return n <= 1 ? 0 : 1 + fault_clog2((n + 1) / 2); }
+
+// Register widths of fifo.sv: PTR_WIDTH = $clog2(DEPTH), count one bit wider
+const int FIFO_PTR_BITS = fault_clog2(FIFO_DEPTH);
+static_assert(FIFO_PTR_BITS >= 1, "fault injection needs a FIFO with at least two entries");
+
+struct Fault {
+    uint64_t cycle;   // flipped before this edge of the campaign (0 = the first)
+    uint32_t index;   // memory entry (FAULT_MEMORY only)
+    uint8_t target;
+    uint8_t bit;
+};
+
+// How a fault ended, seen from the testbench
+enum FaultOutcome {
+    FAULT_DETECTED,     // a checker failed
+    FAULT_MASKED,       // the state reconverged with the golden run first
+    FAULT_LATENT,       // neither, within the window
+    FAULT_CRASHED,      // the run did not finish
+    FAULT_OUTCOMES
+};
+static const char* const FAULT_OUTCOME_NAMES[FAULT_OUTCOMES] = {"detected", "masked", "latent", "crashed"};
+
+// Checkers that failed on the cycle a fault was detected
+// (DETECT_LATENCY: a read out of order, or later than the checker's bound)
+enum { DETECT_SCOREBOARD = 1, DETECT_LATENCY = 2, DETECT_ASSERTION = 4 };
+
+// Bit of a target set in a --fault-targets mask from "memory,wr_ptr,...";
+// 0 if a name is unknown
+inline unsigned fault_parse_targets(const char* list) {
+    unsigned mask = 0;
+    while (*list) {
+        size_t len = strcspn(list, ",");
+        int t = 0;
+        while (t < FAULT_TARGETS && (strlen(FAULT_TARGET_NAMES[t]) != len ||
+                                     strncmp(list, FAULT_TARGET_NAMES[t], len) != 0)) t++;
+        if (t == FAULT_TARGETS) return 0;
+        mask |= 1u << t;
+        list += len + (list[len] == ',');
+    }
+    return mask;
+}
+
+// n faults at uniformly random cycles in [0, cycles), sorted by cycle; the
+// target is uniform over those in mask, the entry and bit uniform within it
+inline std::vector<Fault> fault_sample(Xoshiro256& rng, int n, uint64_t cycles, unsigned mask) {
+    std::vector<int> targets;
+    for (int t = 0; t < FAULT_TARGETS; t++) {
+        if (mask & (1u << t)) targets.push_back(t);
+    }
+    std::vector<Fault> faults(n);
+    for (Fault& f : faults) {
+        f.cycle = rng() % cycles;
+        f.target = (uint8_t)targets[rng() % targets.size()];
+        f.index = f.target == FAULT_MEMORY ? (uint32_t)(rng() % FIFO_DEPTH) : 0;
+        int bits = f.target == FAULT_MEMORY ? FIFO_DATA_WIDTH
+                 : f.target == FAULT_COUNT ? FIFO_PTR_BITS + 1 : FIFO_PTR_BITS;
+        f.bit = (uint8_t)(rng() % bits);
+    }
+    std::stable_sort(faults.begin(), faults.end(),
+                     [](const Fault& a, const Fault& b) { return a.cycle < b.cycle; });
+    return faults;
+}
+
+// =============================================================================
+// Register access - Root is the Verilated root module (dut->rootp)
+// =============================================================================
+
+// One memory entry's share of the state digest
+inline uint64_t fault_mix(uint64_t index, uint64_t value) {
+    uint64_t x = value ^ (index * 0xd6e8feb86659fd93ull);
+    return splitmix64(x);
+}
+
+template <typename Root>
+uint64_t fault_memory_hash(const Root* r) {
+    uint64_t h = 0;
+    for (uint32_t i = 0; i < FIFO_DEPTH; i++) h += fault_mix(i, r->fifo__DOT__memory[i]);
+    return h;
+}
+
+// Digest of the whole register state, given the memory's hash
+template <typename Root>
+uint64_t fault_digest(const Root* r, uint64_t memory_hash) {
+    uint64_t regs = (uint64_t)r->fifo__DOT__wr_ptr | (uint64_t)r->fifo__DOT__rd_ptr << 20 |
+                    (uint64_t)r->fifo__DOT__count_reg << 40;
+    return memory_hash ^ fault_mix(FIFO_DEPTH, regs);
+}
+
+// Flip f's bit; returns the change to the memory hash
+template <typename Root>
+uint64_t fault_flip(Root* r, const Fault& f) {
+    switch (f.target) {
+    case FAULT_MEMORY: {
+        uint64_t before = r->fifo__DOT__memory[f.index];
+        r->fifo__DOT__memory[f.index] ^= 1ull << f.bit;
+        return fault_mix(f.index, r->fifo__DOT__memory[f.index]) - fault_mix(f.index, before);
+    }
+    case FAULT_WR_PTR: r->fifo__DOT__wr_ptr ^= 1u << f.bit; break;
+    case FAULT_RD_PTR: r->fifo__DOT__rd_ptr ^= 1u << f.bit; break;
+    case FAULT_COUNT: r->fifo__DOT__count_reg ^= 1u << f.bit; break;
+    }
+    return 0;
+}
+
+// =============================================================================
+// FaultStats - outcomes per target, and how long detection took
+// =============================================================================
+class FaultStats {
+private:
+    uint64_t outcomes[FAULT_TARGETS][FAULT_OUTCOMES];
+    uint64_t latency_sum[FAULT_TARGETS];    // cycles to detection, detected faults only
+    uint64_t latency_max[FAULT_TARGETS];
+    uint64_t detectors[3];                  // per DETECT_* bit
+
+    static double pct(uint64_t a, uint64_t b) { return b ? 100.0 * a / b : 0.0; }
+
+    static void print_row(const char* name, const uint64_t* o, uint64_t sum, uint64_t max) {
+        uint64_t n = o[0] + o[1] + o[2] + o[3];
+        if (n == 0) return;
+        char lat[32];
+        snprintf(lat, sizeof(lat), "%.1f/%llu", o[FAULT_DETECTED] ? (double)sum / o[FAULT_DETECTED] : 0.0,
+                 (unsigned long long)max);
+        printf("%-10s %7llu %9llu %7llu %7llu %7llu %7.1f%% %15s\n", name, (unsigned long long)n,
+               (unsigned long long)o[FAULT_DETECTED], (unsigned long long)o[FAULT_MASKED],
+               (unsigned long long)o[FAULT_LATENT], (unsigned long long)o[FAULT_CRASHED],
+               pct(o[FAULT_DETECTED], o[FAULT_DETECTED] + o[FAULT_LATENT] + o[FAULT_CRASHED]), lat);
+    }
+
+public:
+    FaultStats() : outcomes(), latency_sum(), latency_max(), detectors() {}
+
+    void record(const Fault& f, int outcome, unsigned detected_by, uint64_t latency) {
+        outcomes[f.target][outcome]++;
+        if (outcome != FAULT_DETECTED) return;
+        latency_sum[f.target] += latency;
+        latency_max[f.target] = std::max(latency_max[f.target], latency);
+        for (int d = 0; d < 3; d++) detectors[d] += (detected_by >> d) & 1;
+    }
+
+    uint64_t count(int outcome) const {
+        uint64_t n = 0;
+        for (int t = 0; t < FAULT_TARGETS; t++) n += outcomes[t][outcome];
+        return n;
+    }
+    uint64_t total() const {
+        uint64_t n = 0;
+        for (int o = 0; o < FAULT_OUTCOMES; o++) n += count(o);
+        return n;
+    }
+
+    // Detected out of the faults that had a lasting effect (masked ones had none)
+    double detection_rate() const {
+        return pct(count(FAULT_DETECTED), count(FAULT_DETECTED) + count(FAULT_LATENT) + count(FAULT_CRASHED));
+    }
+    double mean_latency() const {
+        uint64_t sum = 0;
+        for (int t = 0; t < FAULT_TARGETS; t++) sum += latency_sum[t];
+        uint64_t n = count(FAULT_DETECTED);
+        return n ? (double)sum / n : 0.0;
+    }
+
+    void print_report() const {
+        printf("\n========== Fault Injection Report ==========\n");
+        printf("%-10s %7s %9s %7s %7s %7s %8s %15s\n", "Target", "Faults", "Detected", "Masked", "Latent",
+               "Crashed", "Detect%", "Cycles mean/max");
+        uint64_t all[FAULT_OUTCOMES] = {0, 0, 0, 0}, sum = 0, max = 0;
+        for (int t = 0; t < FAULT_TARGETS; t++) {
+            print_row(FAULT_TARGET_NAMES[t], outcomes[t], latency_sum[t], latency_max[t]);
+            for (int o = 0; o < FAULT_OUTCOMES; o++) all[o] += outcomes[t][o];
+            sum += latency_sum[t];
+            max = std::max(max, latency_max[t]);
+        }
+        print_row("all", all, sum, max);
+        printf("Detected by: scoreboard %llu, latency checker (data order or bound) %llu, assertions %llu "
+               "(a fault can trip several on its first failing cycle)\n",
+               (unsigned long long)detectors[0], (unsigned long long)detectors[1],
+               (unsigned long long)detectors[2]);
+        printf("Detection rate: %.1f%% of the faults that did not reconverge\n", detection_rate());
+        printf("Mean cycles to detection: %.1f\n", mean_latency());
+    }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "fifo_model.h"
+
+// =============================================================================
+// FifoBank - K independent reference FIFOs of the configured DEPTH and
+// DATA_WIDTH, stepped together
+//
+// A C++ twin of one fifo_model.zig instance per lane, stored as
+// structure-of-arrays (memory slot-major: mem[slot * K + lane]) so that one
+// clock edge of every lane is a single branch-free loop over lanes the
+// compiler can vectorize. Used by the lane-batched regression, where the
+// per-call cost of K separate Zig handles would dominate.
+// =============================================================================
+class FifoBank {
+private:
+    size_t lanes;
+    std::vector<uint32_t> wr_ptr;
+    std::vector<uint32_t> rd_ptr;
+    std::vector<uint32_t> count;
+    std::vector<uint64_t> mem;
+
+    static uint32_t next(uint32_t ptr) {
+        if ((FIFO_DEPTH & (FIFO_DEPTH - 1)) == 0) return (ptr + 1) & (FIFO_DEPTH - 1);
+        return ptr == FIFO_DEPTH - 1 ? 0 : ptr + 1;
+    }
+
+public:
+    explicit FifoBank(size_t k) :
+        lanes(k), wr_ptr(k), rd_ptr(k), count(k), mem((size_t)FIFO_DEPTH * k) {}
+
+    size_t size() const { return lanes; }
+
+    // Every lane back to its power-on state (memory cleared, as a new model)
+    void init() {
+        std::fill(wr_ptr.begin(), wr_ptr.end(), 0);
+        std::fill(rd_ptr.begin(), rd_ptr.end(), 0);
+        std::fill(count.begin(), count.end(), 0);
+        std::fill(mem.begin(), mem.end(), 0);
+    }
+
+    // One rising edge on every lane: stim[l] is applied to lane l, entry l of
+    // out receives its outputs after the edge
+    void step(const FifoStim* stim, const FifoOutBuf& out) {
+        uint32_t* __restrict wp = wr_ptr.data();
+        uint32_t* __restrict rp = rd_ptr.data();
+        uint32_t* __restrict cnt = count.data();
+        uint64_t* __restrict m = mem.data();
+
+        for (size_t l = 0; l < lanes; l++) {
+            uint32_t rst = stim[l].rst_n ? ~0u : 0;
+            uint32_t w = (stim[l].wr_en && cnt[l] < FIFO_DEPTH) ? rst : 0;
+            uint32_t r = (stim[l].rd_en && cnt[l] > 0) ? rst : 0;
+
+            uint64_t* slot = &m[(size_t)wp[l] * lanes + l];
+            *slot = w ? (stim[l].data_in & FIFO_DATA_MASK) : *slot;
+            wp[l] = ((w ? next(wp[l]) : wp[l])) & rst;
+            rp[l] = ((r ? next(rp[l]) : rp[l])) & rst;
+            cnt[l] = (cnt[l] + (w & 1) - (r & 1)) & rst;
+
+            out.data_out[l] = m[(size_t)rp[l] * lanes + l];
+            out.count[l] = cnt[l];
+            out.full[l] = cnt[l] == FIFO_DEPTH;
+            out.empty[l] = cnt[l] == 0;
+        }
+    }
+};
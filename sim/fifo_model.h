@@ -0,0 +1,179 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "fifo_types.h"
+#include "fifo_ref.h"    // the header-only C++ backend (MODEL_BACKEND=cpp)
+
+// FIFO configuration under test - must match the -GDEPTH/-GDATA_WIDTH the
+// DUT was Verilated with (the Makefile passes both from FIFO_CONFIGS)
+#ifndef FIFO_DEPTH
+#define FIFO_DEPTH 8
+#endif
+#ifndef FIFO_DATA_WIDTH
+#define FIFO_DATA_WIDTH 8
+#endif
+
+// Wide enough for any supported DATA_WIDTH (1..64)
+typedef uint64_t fifo_data_t;
+
+const fifo_data_t FIFO_DATA_MASK =
+    FIFO_DATA_WIDTH >= 64 ? ~0ull : (1ull << FIFO_DATA_WIDTH) - 1;
+
+// Zig reference model functions (compiled from fifo_model.zig)
+extern "C" {
+    typedef struct FifoHandle FifoHandle;
+
+    FifoHandle* fifo_create(size_t depth, uint32_t data_width);
+    void fifo_destroy(FifoHandle* h);
+    void fifo_inst_init(FifoHandle* h);
+    void fifo_inst_tick(FifoHandle* h);
+    void fifo_inst_set_reset(FifoHandle* h, bool rst_n);
+    void fifo_inst_set_wr_en(FifoHandle* h, bool wr_en);
+    void fifo_inst_set_rd_en(FifoHandle* h, bool rd_en);
+    void fifo_inst_set_data_in(FifoHandle* h, uint64_t data);
+    uint64_t fifo_inst_get_data_out(FifoHandle* h);
+    bool fifo_inst_get_full(FifoHandle* h);
+    bool fifo_inst_get_empty(FifoHandle* h);
+    size_t fifo_inst_get_count(FifoHandle* h);
+    void fifo_inst_get_outputs(FifoHandle* h, FifoOut* out);
+    void fifo_inst_step_batch(FifoHandle* h, const FifoStim* stim, const FifoOutBuf* out, size_t n);
+    size_t fifo_inst_write_burst(FifoHandle* h, const uint64_t* data, size_t n, const FifoOutBuf* out);
+    size_t fifo_inst_read_burst(FifoHandle* h, size_t n, uint64_t* values, const FifoOutBuf* out);
+    size_t fifo_inst_state_size(FifoHandle* h);
+    void fifo_inst_save_state(FifoHandle* h, uint8_t* buf);
+    void fifo_inst_restore_state(FifoHandle* h, const uint8_t* buf);
+}
+
+// =============================================================================
+// FifoModel - owns one reference model instance
+// Each testbench worker creates its own, so no state is shared between threads.
+// Backed by the Zig model, or with -DTB_MODEL_CPP (make MODEL_BACKEND=cpp) by
+// FifoRef, whose steps the compiler can inline into the testbench loops.
+// =============================================================================
+#ifdef TB_MODEL_CPP
+class FifoModel {
+private:
+    typedef FifoRef<FIFO_DEPTH, FIFO_DATA_WIDTH> Ref;
+    // The high half of a checkpoint's size word marks this backend, so a
+    // checkpoint never restores into the other one
+    static const uint64_t STATE_TAG = 1ull << 32;
+
+    Ref ref;
+    static_assert(std::is_trivially_copyable<Ref>::value, "checkpoints copy the model as bytes");
+
+public:
+    FifoModel() {}
+
+    FifoModel(const FifoModel&) = delete;
+    FifoModel& operator=(const FifoModel&) = delete;
+
+    void init() { ref.init(); }
+    void tick() { ref.tick(); }
+
+    void set_reset(bool rst_n) { ref.set_reset(rst_n); }
+    void set_wr_en(bool wr_en) { ref.set_wr_en(wr_en); }
+    void set_rd_en(bool rd_en) { ref.set_rd_en(rd_en); }
+    void set_data_in(fifo_data_t data) { ref.set_data_in(data); }
+
+    fifo_data_t get_data_out() { return ref.data_out(); }
+    bool get_full() { return ref.full(); }
+    bool get_empty() { return ref.empty(); }
+    size_t get_count() { return ref.count(); }
+
+    void get_outputs(FifoOut* out) { *out = ref.outputs(); }
+
+    void step_batch(const FifoStim* stim, const FifoOutBuf& out, size_t n) {
+        ref.step_batch(stim, out, n);
+    }
+
+    size_t write_burst(const uint64_t* data, size_t n, const FifoOutBuf* out = NULL) {
+        return ref.write_burst(data, n, out);
+    }
+    size_t read_burst(size_t n, uint64_t* values, const FifoOutBuf* out = NULL) {
+        return ref.read_burst(n, values, out);
+    }
+
+    void save_state(std::vector<uint64_t>& out) {
+        out.assign(1 + (sizeof(Ref) + 7) / 8, 0);
+        out[0] = STATE_TAG | sizeof(Ref);
+        memcpy(&out[1], &ref, sizeof(Ref));
+    }
+    bool restore_state(const std::vector<uint64_t>& in) {
+        if (in.empty() || in[0] != (STATE_TAG | sizeof(Ref)) || in.size() != 1 + (sizeof(Ref) + 7) / 8) {
+            return false;
+        }
+        memcpy((void*)&ref, &in[1], sizeof(Ref));   // a plain image (trivially copyable)
+        return true;
+    }
+};
+#else
+class FifoModel {
+private:
+    FifoHandle* h;
+
+public:
+    FifoModel() : h(fifo_create(FIFO_DEPTH, FIFO_DATA_WIDTH)) {
+        if (!h) {
+            fprintf(stderr, "FifoModel: no reference model for DEPTH=%d DATA_WIDTH=%d "
+                            "(add it to the config matrix in fifo_model.zig)\n",
+                    FIFO_DEPTH, FIFO_DATA_WIDTH);
+            abort();
+        }
+    }
+    ~FifoModel() { fifo_destroy(h); }
+
+    FifoModel(const FifoModel&) = delete;
+    FifoModel& operator=(const FifoModel&) = delete;
+
+    void init() { fifo_inst_init(h); }
+    void tick() { fifo_inst_tick(h); }
+
+    void set_reset(bool rst_n) { fifo_inst_set_reset(h, rst_n); }
+    void set_wr_en(bool wr_en) { fifo_inst_set_wr_en(h, wr_en); }
+    void set_rd_en(bool rd_en) { fifo_inst_set_rd_en(h, rd_en); }
+    void set_data_in(fifo_data_t data) { fifo_inst_set_data_in(h, data); }
+
+    fifo_data_t get_data_out() { return fifo_inst_get_data_out(h); }
+    bool get_full() { return fifo_inst_get_full(h); }
+    bool get_empty() { return fifo_inst_get_empty(h); }
+    size_t get_count() { return fifo_inst_get_count(h); }
+
+    // All outputs in one call
+    void get_outputs(FifoOut* out) { fifo_inst_get_outputs(h, out); }
+
+    // Step n cycles: stim[i] is applied before edge i, entry i of out holds the outputs after it
+    void step_batch(const FifoStim* stim, const FifoOutBuf& out, size_t n) {
+        fifo_inst_step_batch(h, stim, &out, n);
+    }
+
+    // Transaction-level bursts: n cycles of pure writes (data[i] on cycle i) or
+    // pure reads in O(1) plus a copy. Return the writes accepted / reads done
+    // (the rest hit a full / empty FIFO); values receives the data read, and
+    // out, if given, the per-cycle outputs as step_batch would produce them.
+    size_t write_burst(const uint64_t* data, size_t n, const FifoOutBuf* out = NULL) {
+        return fifo_inst_write_burst(h, data, n, out);
+    }
+    size_t read_burst(size_t n, uint64_t* values, const FifoOutBuf* out = NULL) {
+        return fifo_inst_read_burst(h, n, values, out);
+    }
+
+    // Checkpointing: the model's byte image, padded to whole words
+    void save_state(std::vector<uint64_t>& out) {
+        size_t bytes = fifo_inst_state_size(h);
+        out.assign(1 + (bytes + 7) / 8, 0);
+        out[0] = bytes;
+        fifo_inst_save_state(h, (uint8_t*)&out[1]);
+    }
+    bool restore_state(const std::vector<uint64_t>& in) {
+        if (in.empty() || in[0] != fifo_inst_state_size(h) || in.size() != 1 + (in[0] + 7) / 8) {
+            return false;
+        }
+        fifo_inst_restore_state(h, (const uint8_t*)&in[1]);
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "fifo_model.h"
+#include "scoreboard.h"
+
+// =============================================================================
+// Runtime protocol monitors - the SVA invariants of rtl/fifo.sv, in C++
+//
+// The assert properties in the FORMAL block of fifo.sv never run in a
+// Verilated build (no FORMAL define, no --assert), and turning on Verilator
+// assertions costs every cycle. The monitor checks the same invariants on
+// the DUT's ports instead, in the testbench loop, over the batches the
+// scoreboard already records: all four in one branch-free pass that builds a
+// 64-cycle violation bitmap per property, so a passing batch costs a few
+// ALU operations per cycle and a popcount.
+//
+// Like the SVA's disable iff (!rst_n), a cycle is not checked when reset was
+// applied before its edge. Every property records how often it failed and
+// the first cycle it did; the first failure of each is printed.
+//
+// Testbenches add properties of their own with monitor_register() (before
+// any threads start), as a block check over the same signals -
+// monitor_block<> makes one from a per-cycle predicate.
+// =============================================================================
+
+// What a property sees: entry i of each stream is one cycle - the inputs
+// applied before its rising edge and the DUT outputs after it
+struct MonitorView {
+    const FifoStim* in;
+    const uint64_t* data_out;
+    const uint32_t* count;
+    const uint8_t* full;
+    const uint8_t* empty;
+};
+
+inline MonitorView monitor_view(const FifoStim* in, const FifoOutputs& out) {
+    MonitorView v = {in, out.data_out_stream(), out.count_stream(), out.full_stream(), out.empty_stream()};
+    return v;
+}
+
+// Bit j of the result is set if the property fails on cycle base + j (len <= 64)
+typedef uint64_t (*MonitorCheck)(const MonitorView& v, size_t base, size_t len);
+
+// A block check from a per-cycle predicate, unrolled and inlined by the compiler
+template <bool (*HOLDS)(const MonitorView&, size_t)>
+uint64_t monitor_block(const MonitorView& v, size_t base, size_t len) {
+    uint64_t bits = 0;
+    for (size_t j = 0; j < len; j++) bits |= (uint64_t)!HOLDS(v, base + j) << j;
+    return bits;
+}
+
+struct MonitorProperty {
+    const char* name;
+    const char* message;
+    MonitorCheck check;   // NULL for the built-in ones, checked in one fused pass
+};
+
+// The assertions of fifo.sv, in the order of the registry
+enum { MON_COUNT_LE_DEPTH, MON_NOT_FULL_AND_EMPTY, MON_FULL_COUNT, MON_EMPTY_COUNT, MON_BUILTIN };
+
+namespace monitor_detail {
+
+inline std::vector<MonitorProperty>& registry() {
+    static std::vector<MonitorProperty> props = {
+        {"count_le_depth", "Count exceeded FIFO depth", NULL},
+        {"not_full_and_empty", "FIFO both full and empty", NULL},
+        {"full_count", "Full flag inconsistent with count", NULL},
+        {"empty_count", "Empty flag inconsistent with count", NULL},
+    };
+    return props;
+}
+
+}  // namespace monitor_detail
+
+// Register a property by name (before any threads start); returns its id
+inline int monitor_register(const char* name, const char* message, MonitorCheck check) {
+    std::vector<MonitorProperty>& props = monitor_detail::registry();
+    for (size_t i = 0; i < props.size(); i++) {
+        if (strcmp(props[i].name, name) == 0) return (int)i;
+    }
+    props.push_back(MonitorProperty{name, message, check});
+    return (int)props.size() - 1;
+}
+
+// =============================================================================
+// FifoMonitor - per-seed property results; never shared between threads
+// =============================================================================
+class FifoMonitor {
+private:
+    static constexpr uint64_t NONE = ~0ull;
+
+    std::vector<uint64_t> failures;      // per property
+    std::vector<uint64_t> first_cycle;   // per property, NONE if it never failed
+    uint64_t checked;                    // cycles out of reset
+
+    static const std::vector<MonitorProperty>& props() { return monitor_detail::registry(); }
+
+    // Slow path, for blocks where property p failed
+    uint64_t record(size_t p, uint64_t bits, const MonitorView& v, size_t base, uint64_t base_cycle) {
+        uint64_t n = __builtin_popcountll(bits);
+        failures[p] += n;
+        if (first_cycle[p] != NONE) return n;
+        size_t i = base + __builtin_ctzll(bits);
+        first_cycle[p] = base_cycle + __builtin_ctzll(bits);
+        printf("  [ASSERT] Cycle %llu: %s - %s (count=%u full=%d empty=%d)\n",
+               (unsigned long long)first_cycle[p], props()[p].name, props()[p].message, v.count[i],
+               v.full[i], v.empty[i]);
+        return n;
+    }
+
+public:
+    FifoMonitor() { clear(); }
+
+    void clear() {
+        failures.assign(props().size(), 0);
+        first_cycle.assign(props().size(), NONE);
+        checked = 0;
+    }
+
+    // Check entries [begin, end) of v, entry begin being cycle begin_cycle.
+    // Returns the number of property failures found.
+    uint64_t check(const MonitorView& v, size_t begin, size_t end, uint64_t begin_cycle) {
+        uint64_t found = 0;
+        for (size_t base = begin; base < end; base += 64) {
+            size_t len = end - base < 64 ? end - base : 64;
+            uint64_t on = 0;
+            uint64_t bad[MON_BUILTIN] = {0, 0, 0, 0};
+            for (size_t j = 0; j < len; j++) {
+                size_t i = base + j;
+                uint32_t c = v.count[i];
+                uint64_t f = v.full[i] != 0;
+                uint64_t e = v.empty[i] != 0;
+                on |= (uint64_t)(v.in[i].rst_n != 0) << j;
+                bad[MON_COUNT_LE_DEPTH] |= (uint64_t)(c > FIFO_DEPTH) << j;
+                bad[MON_NOT_FULL_AND_EMPTY] |= (f & e) << j;
+                bad[MON_FULL_COUNT] |= (f & (c != FIFO_DEPTH)) << j;
+                bad[MON_EMPTY_COUNT] |= (e & (c != 0)) << j;
+            }
+            checked += __builtin_popcountll(on);
+            uint64_t base_cycle = begin_cycle + (base - begin);
+
+            if ((bad[0] | bad[1] | bad[2] | bad[3]) & on) {
+                for (int p = 0; p < MON_BUILTIN; p++) {
+                    if (bad[p] & on) found += record(p, bad[p] & on, v, base, base_cycle);
+                }
+            }
+            for (size_t p = MON_BUILTIN; p < failures.size(); p++) {
+                uint64_t bits = props()[p].check(v, base, len) & on;
+                if (bits) found += record(p, bits, v, base, base_cycle);
+            }
+        }
+        return found;
+    }
+
+    uint64_t get_checked() const { return checked; }
+    // Earliest cycle any property failed on, ~0 if none did
+    uint64_t first_failure() const {
+        uint64_t first = NONE;
+        for (uint64_t c : first_cycle) {
+            if (c < first) first = c;
+        }
+        return first;
+    }
+    uint64_t total_failures() const {
+        uint64_t n = 0;
+        for (uint64_t f : failures) n += f;
+        return n;
+    }
+
+    void merge(const FifoMonitor& other) {
+        checked += other.checked;
+        for (size_t p = 0; p < failures.size(); p++) {
+            failures[p] += other.failures[p];
+            if (other.first_cycle[p] < first_cycle[p]) first_cycle[p] = other.first_cycle[p];
+        }
+    }
+
+    // Checked cycles, then failures and first failing cycle per property
+    void save_state(std::vector<uint64_t>& out) const {
+        out.assign({checked, (uint64_t)failures.size()});
+        out.insert(out.end(), failures.begin(), failures.end());
+        out.insert(out.end(), first_cycle.begin(), first_cycle.end());
+    }
+    bool restore_state(const std::vector<uint64_t>& in) {
+        size_t n = failures.size();
+        if (in.size() != 2 + 2 * n || in[1] != n) return false;
+        checked = in[0];
+        failures.assign(in.begin() + 2, in.begin() + 2 + n);
+        first_cycle.assign(in.begin() + 2 + n, in.end());
+        return true;
+    }
+
+    void print_report() const {
+        printf("\nAssertions: %llu cycles checked, %llu failures\n", (unsigned long long)checked,
+               (unsigned long long)total_failures());
+        for (size_t p = 0; p < failures.size(); p++) {
+            printf("  %-20s %llu failures", props()[p].name, (unsigned long long)failures[p]);
+            if (first_cycle[p] != NONE) printf(" (first at cycle %llu)", (unsigned long long)first_cycle[p]);
+            printf("\n");
+        }
+    }
+};
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include "fifo_types.h"
+
+// =============================================================================
+// FifoRef<DEPTH, DATA_WIDTH> - header-only C++ twin of the Zig FIFO model
+//
+// The same cycle behavior as Fifo(DEPTH, DATA_WIDTH) in fifo_model.zig, down
+// to the inputs a burst leaves latched, but visible to the compiler: built
+// with MODEL_BACKEND=cpp, FifoModel (fifo_model.h) steps this class and the
+// model calls inline into the testbench loops instead of crossing into an
+// opaque object file. Everything is constexpr, so the behavior is checked at
+// compile time below; make check_models runs it against the Zig model.
+// Records and output buffers are the testbench's own (fifo_types.h).
+// =============================================================================
+
+// Smallest unsigned type holding DATA_WIDTH bits, as Zig's uN is stored
+template <unsigned W>
+using FifoRefWord = typename std::conditional<W <= 8, uint8_t,
+                    typename std::conditional<W <= 16, uint16_t,
+                    typename std::conditional<W <= 32, uint32_t, uint64_t>::type>::type>::type;
+
+template <size_t DEPTH, unsigned DATA_WIDTH>
+class FifoRef {
+    static_assert(DEPTH >= 1, "FIFO depth must be at least 1");
+    static_assert(DATA_WIDTH >= 1 && DATA_WIDTH <= 64, "FIFO data width must be 1..64 bits");
+
+public:
+    typedef FifoRefWord<DATA_WIDTH> Data;
+    static constexpr uint64_t MASK = DATA_WIDTH >= 64 ? ~0ull : (1ull << DATA_WIDTH) - 1;
+
+private:
+    Data memory[DEPTH] = {};
+    size_t wr_ptr = 0;
+    size_t rd_ptr = 0;
+    size_t count_ = 0;
+
+    // Inputs, latched until changed (set before tick)
+    bool wr_en = false;
+    bool rd_en = false;
+    Data data_in = 0;
+    bool rst_n = false;
+
+    static constexpr size_t next(size_t ptr) {
+        if ((DEPTH & (DEPTH - 1)) == 0) return (ptr + 1) & (DEPTH - 1);
+        return ptr == DEPTH - 1 ? 0 : ptr + 1;
+    }
+
+    // Pointer advanced by k <= DEPTH entries
+    static constexpr size_t advance(size_t ptr, size_t k) {
+        if ((DEPTH & (DEPTH - 1)) == 0) return (ptr + k) & (DEPTH - 1);
+        return ptr + k >= DEPTH ? ptr + k - DEPTH : ptr + k;
+    }
+
+    constexpr void put(size_t i, const FifoOutBuf& o) const {
+        o.data_out[i] = data_out();
+        o.count[i] = (uint32_t)count_;
+        o.full[i] = full();
+        o.empty[i] = empty();
+    }
+
+    // A burst issued while reset is held: every cycle just resets
+    constexpr size_t hold_in_reset(size_t n, const FifoOutBuf* out) {
+        tick();
+        for (size_t i = 0; out && i < n; i++) put(i, *out);
+        return 0;
+    }
+
+public:
+    constexpr void init() { *this = FifoRef(); }
+
+    // One rising clock edge - mimics the RTL behavior
+    constexpr void tick() {
+        if (!rst_n) {
+            wr_ptr = 0;
+            rd_ptr = 0;
+            count_ = 0;
+            return;
+        }
+        bool can_write = wr_en && count_ < DEPTH;
+        bool can_read = rd_en && count_ > 0;
+        if (can_write) {
+            memory[wr_ptr] = data_in;
+            wr_ptr = next(wr_ptr);
+        }
+        if (can_read) rd_ptr = next(rd_ptr);
+        count_ = count_ + can_write - can_read;
+    }
+
+    constexpr void set_reset(bool v) { rst_n = v; }
+    constexpr void set_wr_en(bool v) { wr_en = v; }
+    constexpr void set_rd_en(bool v) { rd_en = v; }
+    // Truncated to DATA_WIDTH, like the RTL port
+    constexpr void set_data_in(uint64_t v) { data_in = (Data)(v & MASK); }
+
+    constexpr uint64_t data_out() const { return memory[rd_ptr]; }
+    constexpr bool full() const { return count_ == DEPTH; }
+    constexpr bool empty() const { return count_ == 0; }
+    constexpr size_t count() const { return count_; }
+
+    constexpr FifoOut outputs() const {
+        FifoOut o = {};
+        o.data_out = data_out();
+        o.count = (uint32_t)count_;
+        o.full = full();
+        o.empty = empty();
+        return o;
+    }
+
+    // n cycles: stim[i] applied before edge i, entry i of out after it
+    // (the inputs of the last record stay latched)
+    constexpr void step_batch(const FifoStim* stim, const FifoOutBuf& out, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            wr_en = stim[i].wr_en;
+            rd_en = stim[i].rd_en;
+            rst_n = stim[i].rst_n;
+            data_in = (Data)(stim[i].data_in & MASK);
+            tick();
+            put(i, out);
+        }
+    }
+
+    // n cycles of wr_en=1 with data[i] on cycle i, in O(1) plus a copy.
+    // Returns the writes accepted (the rest hit a full FIFO); out, if
+    // given, receives the outputs after every cycle.
+    constexpr size_t write_burst(const uint64_t* data, size_t n, const FifoOutBuf* out) {
+        if (n == 0) return 0;
+        wr_en = true;
+        rd_en = false;
+        data_in = (Data)(data[n - 1] & MASK);
+        if (!rst_n) return hold_in_reset(n, out);
+
+        size_t count0 = count_;
+        size_t accepted = n < DEPTH - count0 ? n : DEPTH - count0;
+        for (size_t i = 0; i < accepted; i++) {
+            memory[wr_ptr] = (Data)(data[i] & MASK);
+            wr_ptr = next(wr_ptr);
+        }
+        count_ += accepted;
+
+        // Writes never touch the head slot of a non-empty FIFO
+        for (size_t i = 0; out && i < n; i++) {
+            size_t c = count0 + i + 1 < DEPTH ? count0 + i + 1 : DEPTH;
+            out->data_out[i] = data_out();
+            out->count[i] = (uint32_t)c;
+            out->full[i] = c == DEPTH;
+            out->empty[i] = 0;
+        }
+        return accepted;
+    }
+
+    // n cycles of rd_en=1. Returns the reads done (the rest hit an empty
+    // FIFO); values, if given, receives the data read, oldest first
+    constexpr size_t read_burst(size_t n, uint64_t* values, const FifoOutBuf* out) {
+        if (n == 0) return 0;
+        wr_en = false;
+        rd_en = true;
+        if (!rst_n) return hold_in_reset(n, out);
+
+        size_t count0 = count_;
+        size_t rd0 = rd_ptr;
+        size_t reads = n < count0 ? n : count0;
+        for (size_t k = 0; values && k < reads; k++) values[k] = memory[advance(rd0, k)];
+        rd_ptr = advance(rd0, reads);
+        count_ -= reads;
+
+        for (size_t i = 0; out && i < n; i++) {
+            size_t k = i + 1 < count0 ? i + 1 : count0;
+            size_t c = count0 - k;
+            out->data_out[i] = memory[advance(rd0, k)];
+            out->count[i] = (uint32_t)c;
+            out->full[i] = c == DEPTH;
+            out->empty[i] = c == 0;
+        }
+        return reads;
+    }
+};
+
+// =============================================================================
+// Compile-time checks: the basic contract of the model, evaluated by the
+// compiler wherever this header is included
+// =============================================================================
+// Write three, read one; data order, count and flags along the way
+constexpr bool fifo_ref_basic() {
+    FifoRef<4, 8> f;
+    f.set_reset(false);
+    f.tick();
+    if (!f.empty() || f.count() != 0) return false;
+    f.set_reset(true);
+    f.set_wr_en(true);
+    for (uint64_t v = 0x1a1; v < 0x1a4; v++) {
+        f.set_data_in(v);   // truncated to 8 bits
+        f.tick();
+    }
+    if (f.count() != 3 || f.data_out() != 0xa1) return false;
+    f.set_wr_en(false);
+    f.set_rd_en(true);
+    f.tick();
+    return f.count() == 2 && f.data_out() == 0xa2 && !f.full() && !f.empty();
+}
+
+// Writes past full are dropped, reads past empty do nothing, pointers wrap
+// (non-power-of-two depth)
+constexpr bool fifo_ref_limits() {
+    FifoRef<3, 16> f;
+    f.set_reset(true);
+    uint64_t data[5] = {1, 2, 3, 4, 5};
+    if (f.write_burst(data, 5, nullptr) != 3 || !f.full()) return false;
+    uint64_t got[5] = {};
+    if (f.read_burst(5, got, nullptr) != 3 || !f.empty()) return false;
+    if (got[0] != 1 || got[1] != 2 || got[2] != 3) return false;
+    if (f.write_burst(data + 3, 2, nullptr) != 2 || f.data_out() != 4) return false;
+    // Reset clears pointers and count but not memory
+    f.set_reset(false);
+    f.tick();
+    return f.empty() && f.data_out() == 4;
+}
+
+static_assert(fifo_ref_basic(), "FifoRef: basic write/read");
+static_assert(fifo_ref_limits(), "FifoRef: full/empty limits, wraparound, reset");
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+// =============================================================================
+// Per-cycle records shared by the FIFO reference models and the testbenches
+// (packed for batched lock-step stepping; layouts shared with fifo_model.zig,
+// keep the two in sync)
+// =============================================================================
+struct FifoStim {          // inputs applied before one rising edge
+    uint64_t data_in;
+    uint8_t  wr_en;
+    uint8_t  rd_en;
+    uint8_t  rst_n;
+    uint8_t  _pad[5];
+};
+
+struct FifoOut {           // outputs observed after that edge
+    uint64_t data_out;
+    uint32_t count;
+    uint8_t  full;
+    uint8_t  empty;
+    uint8_t  _pad[2];
+};
+
+// Structure-of-arrays output streams, one entry per cycle
+struct FifoOutBuf {
+    uint64_t* data_out;
+    uint32_t* count;
+    uint8_t*  full;
+    uint8_t*  empty;
+};
+
+static_assert(sizeof(FifoStim) == 16, "FifoStim layout must match fifo_model.zig");
+static_assert(sizeof(FifoOut) == 16, "FifoOut layout must match fifo_model.zig");
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// =============================================================================
+// ForkPool - run jobs in fork()ed children, at most N at a time (POSIX only)
+//
+// A child starts as a copy-on-write image of the parent at the moment of
+// spawn(), so state built up once (a DUT out of reset, say) is shared by
+// every job without being copied or made thread-safe. Each job returns a
+// list of 64-bit words, which the child writes to a pipe before exiting;
+// the parent collects it together with the child's exit status.
+// =============================================================================
+class ForkPool {
+public:
+    struct Result {
+        int id;
+        int status;                   // as from waitpid()
+        std::vector<uint64_t> words;  // what the job returned (partial if it crashed)
+
+        // The job ran to completion (its own verdict is in words)
+        bool completed() const { return WIFEXITED(status) && WEXITSTATUS(status) == 0; }
+    };
+
+private:
+    struct Child {
+        pid_t pid;
+        int fd;
+        int id;
+        std::vector<uint8_t> bytes;
+    };
+
+    int max_children;
+    std::vector<Child> running;
+
+    // Drain whatever the children have written; reap those that closed
+    // their pipe. Blocks until at least one pipe is ready.
+    void collect(std::vector<Result>& done) {
+        std::vector<pollfd> fds(running.size());
+        for (size_t i = 0; i < running.size(); i++) fds[i] = {running[i].fd, POLLIN, 0};
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) return;
+            perror("poll");
+            return;
+        }
+
+        for (size_t i = running.size(); i-- > 0;) {
+            if (!fds[i].revents) continue;
+            Child& c = running[i];
+            uint8_t buf[65536];
+            ssize_t n = read(c.fd, buf, sizeof(buf));
+            if (n < 0 && errno == EINTR) continue;
+            if (n > 0) {
+                c.bytes.insert(c.bytes.end(), buf, buf + n);
+                continue;
+            }
+
+            // EOF (or a broken pipe): the child is done
+            close(c.fd);
+            Result r;
+            r.id = c.id;
+            while (waitpid(c.pid, &r.status, 0) < 0 && errno == EINTR) {}
+            r.words.resize(c.bytes.size() / sizeof(uint64_t));
+            if (!r.words.empty()) memcpy(r.words.data(), c.bytes.data(), r.words.size() * sizeof(uint64_t));
+            done.push_back(r);
+            running.erase(running.begin() + i);
+        }
+    }
+
+    static void write_all(int fd, const void* data, size_t len) {
+        const uint8_t* p = (const uint8_t*)data;
+        while (len > 0) {
+            ssize_t n = write(fd, p, len);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return;
+            p += n;
+            len -= n;
+        }
+    }
+
+public:
+    explicit ForkPool(int n) : max_children(n < 1 ? 1 : n) {}
+
+    ~ForkPool() {
+        std::vector<Result> ignored;
+        wait_all(ignored);
+    }
+
+    // Run job() (returning std::vector<uint64_t>) in a new child, first
+    // waiting for a free slot; results that arrive meanwhile go to done.
+    // Returns false if the child could not be started.
+    template <typename Job>
+    bool spawn(int id, Job job, std::vector<Result>& done) {
+        while ((int)running.size() >= max_children) collect(done);
+
+        int p[2];
+        if (pipe(p) != 0) return false;
+        // Anything still buffered would otherwise be printed by both processes
+        fflush(stdout);
+        fflush(stderr);
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(p[0]);
+            close(p[1]);
+            return false;
+        }
+        if (pid == 0) {
+            close(p[0]);
+            for (const Child& c : running) close(c.fd);
+            std::vector<uint64_t> words = job();
+            write_all(p[1], words.data(), words.size() * sizeof(uint64_t));
+            close(p[1]);
+            fflush(stdout);
+            fflush(stderr);
+            _exit(0);   // no atexit handlers or destructors of the parent's objects
+        }
+
+        close(p[1]);
+        running.push_back(Child{pid, p[0], id, std::vector<uint8_t>()});
+        return true;
+    }
+
+    void wait_all(std::vector<Result>& done) {
+        while (!running.empty()) collect(done);
+    }
+};
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+// =============================================================================
+// Work queue between the regression dispatcher and its workers
+//
+// A work unit is one shard of the seed space on one FIFO configuration and
+// build profile; running it yields one result record (result_file.h). The
+// dispatcher submits units and watches them, workers on any number of hosts
+// claim and run them. JobQueue is the interface the two sides program
+// against; DirQueue implements it on a directory, which is all a local run
+// or a cluster with a shared filesystem needs - a socket or broker backed
+// queue only has to provide the same calls.
+// =============================================================================
+
+struct WorkUnit {
+    std::string id;        // config-profile-shard, e.g. 16x32-fast-0042
+    std::string config;    // DEPTHxDATA_WIDTH
+    std::string profile;   // Makefile PROFILE the testbench was built with
+    uint64_t first_seed;
+    uint32_t seeds;
+    std::string args;      // extra testbench arguments
+    int ticket;            // 0, then one more for every retry or duplicate
+    std::string worker;    // who claimed it (empty while pending)
+};
+
+// A claimed unit, as the dispatcher sees it (times in seconds since the epoch)
+struct RunningUnit {
+    WorkUnit unit;
+    double claimed;
+    double heartbeat;
+};
+
+struct QueueSnapshot {
+    std::vector<WorkUnit> pending;
+    std::vector<RunningUnit> running;
+    std::vector<WorkUnit> failed;      // the worker could not produce a result
+    std::vector<std::string> done;     // ids with a result
+};
+
+class JobQueue {
+public:
+    virtual ~JobQueue() {}
+
+    // Dispatcher side
+    virtual bool submit(const WorkUnit& u) = 0;
+    virtual bool snapshot(QueueSnapshot& s) = 0;
+    // Back to pending as ticket, from running (a lost worker) or failed
+    virtual bool requeue(const WorkUnit& u, int ticket) = 0;
+    // A failed or lost unit that will not be retried
+    virtual void abandon(const WorkUnit& u) = 0;
+    // Drop pending tickets of a unit that has a result
+    virtual void cancel(const std::string& id) = 0;
+    virtual std::string result_path(const std::string& id) = 0;
+    // No more work: idle workers exit
+    virtual void close() = 0;
+
+    // Worker side
+    virtual bool claim(const std::string& worker, WorkUnit* u) = 0;
+    virtual void heartbeat(const WorkUnit& u) = 0;
+    // Where the run writes its result and log before finish() publishes it
+    virtual std::string scratch_path(const WorkUnit& u, const char* ext) = 0;
+    virtual bool finish(const WorkUnit& u) = 0;
+    virtual void fail(const WorkUnit& u) = 0;
+    virtual bool closed() = 0;
+};
+
+inline double wall_seconds() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// =============================================================================
+// DirQueue - the queue as a directory tree, for local runs and shared
+// filesystems. A unit is a small text file whose directory is its state:
+//   units/ID              every unit of the run (what the report expects)
+//   pending/ID~TICKET     waiting to be claimed
+//   running/ID~TICKET@W   claimed by worker W; mtime is its heartbeat
+//   failed/ID~TICKET@W    W ran it and got no result
+//   dead/ID~TICKET@W      failed or lost too often, not retried
+//   done/ID.res           the result record; work/ holds results being
+//                         written and the testbenches' logs
+//   CLOSED                the dispatcher is done
+// Claims are rename()s, atomic on local filesystems and NFS alike, so every
+// ticket runs once; a unit can still have several tickets (retries, straggler
+// duplicates), and the first result published wins.
+// =============================================================================
+class DirQueue : public JobQueue {
+private:
+    std::string root;
+
+    std::string path(const char* dir, const std::string& name) const { return root + "/" + dir + "/" + name; }
+
+    static std::string ticket_name(const WorkUnit& u) { return u.id + "~" + std::to_string(u.ticket); }
+    static std::string claimed_name(const WorkUnit& u) { return ticket_name(u) + "@" + u.worker; }
+
+    static bool write_text(const std::string& file, const std::string& text) {
+        std::string tmp = file + ".tmp";
+        FILE* f = fopen(tmp.c_str(), "w");
+        if (!f) return false;
+        bool ok = fputs(text.c_str(), f) >= 0;
+        ok = fclose(f) == 0 && ok;
+        return ok && rename(tmp.c_str(), file.c_str()) == 0;
+    }
+
+    // Unit description: one line of fields, one of testbench arguments
+    static std::string describe(const WorkUnit& u) {
+        return u.config + " " + u.profile + " " + std::to_string(u.first_seed) + " " +
+               std::to_string(u.seeds) + "\n" + u.args + "\n";
+    }
+
+    // Parse a unit file named ID~TICKET[@WORKER] (or just ID, in units/)
+    static bool read_unit(const std::string& file, const std::string& name, WorkUnit* u, double* claimed) {
+        FILE* f = fopen(file.c_str(), "r");
+        if (!f) return false;
+        char config[64], profile[64], line[1024];
+        unsigned long long first;
+        unsigned seeds;
+        bool ok = fscanf(f, "%63s %63s %llu %u", config, profile, &first, &seeds) == 4;
+        if (ok) {
+            fgets(line, sizeof(line), f);   // rest of the first line
+            u->args = fgets(line, sizeof(line), f) ? line : "";
+            while (!u->args.empty() && u->args.back() == '\n') u->args.pop_back();
+            double t = 0;
+            if (claimed && fscanf(f, "claimed %lf", &t) == 1) *claimed = t;
+        }
+        fclose(f);
+        if (!ok) return false;
+
+        u->config = config;
+        u->profile = profile;
+        u->first_seed = first;
+        u->seeds = seeds;
+        size_t at = name.find('@');
+        size_t tilde = name.rfind('~', at);
+        u->id = name.substr(0, tilde);
+        u->ticket = tilde == std::string::npos ? 0 : atoi(name.c_str() + tilde + 1);
+        u->worker = at == std::string::npos ? "" : name.substr(at + 1);
+        return true;
+    }
+
+    std::vector<std::string> list(const char* dir) const {
+        std::vector<std::string> names;
+        DIR* d = opendir((root + "/" + dir).c_str());
+        if (!d) return names;
+        while (struct dirent* e = readdir(d)) {
+            std::string n = e->d_name;
+            if (n[0] == '.' || (n.size() > 4 && n.compare(n.size() - 4, 4, ".tmp") == 0)) continue;
+            names.push_back(n);
+        }
+        closedir(d);
+        return names;
+    }
+
+public:
+    explicit DirQueue(const std::string& dir) : root(dir) {}
+
+    // Create the directory tree; fresh also clears out a previous run
+    bool create(bool fresh) {
+        static const char* const DIRS[] = {"units", "pending", "running", "failed", "dead", "done", "work"};
+        mkdir(root.c_str(), 0777);
+        for (const char* d : DIRS) {
+            std::string p = root + "/" + d;
+            if (mkdir(p.c_str(), 0777) != 0 && errno != EEXIST) return false;
+            if (!fresh) continue;
+            for (const std::string& n : list(d)) unlink((p + "/" + n).c_str());
+        }
+        if (fresh) unlink((root + "/CLOSED").c_str());
+        return true;
+    }
+
+    std::vector<WorkUnit> units() const {
+        std::vector<WorkUnit> all;
+        for (const std::string& n : list("units")) {
+            WorkUnit u;
+            if (read_unit(path("units", n), n, &u, NULL)) all.push_back(u);
+        }
+        return all;
+    }
+
+    // ---- Dispatcher side ---------------------------------------------------
+    bool submit(const WorkUnit& u) override {
+        std::string text = describe(u);
+        if (u.ticket == 0 && !write_text(path("units", u.id), text)) return false;
+        return write_text(path("pending", ticket_name(u)), text);
+    }
+
+    bool snapshot(QueueSnapshot& s) override {
+        s = QueueSnapshot();
+        WorkUnit u;
+        for (const std::string& n : list("pending")) {
+            if (read_unit(path("pending", n), n, &u, NULL)) s.pending.push_back(u);
+        }
+        for (const std::string& n : list("running")) {
+            RunningUnit r;
+            r.claimed = 0;
+            struct stat st;
+            std::string p = path("running", n);
+            if (!read_unit(p, n, &r.unit, &r.claimed) || stat(p.c_str(), &st) != 0) continue;
+            r.heartbeat = st.st_mtime;
+            if (r.claimed == 0) r.claimed = r.heartbeat;
+            s.running.push_back(r);
+        }
+        for (const std::string& n : list("failed")) {
+            if (read_unit(path("failed", n), n, &u, NULL)) s.failed.push_back(u);
+        }
+        for (const std::string& n : list("done")) {
+            if (n.size() > 4 && n.compare(n.size() - 4, 4, ".res") == 0) s.done.push_back(n.substr(0, n.size() - 4));
+        }
+        return true;
+    }
+
+    bool requeue(const WorkUnit& u, int ticket) override {
+        WorkUnit next = u;
+        next.ticket = ticket;
+        next.worker.clear();
+        std::string from = path("running", claimed_name(u));
+        if (access(from.c_str(), F_OK) != 0) from = path("failed", claimed_name(u));
+        // Rewritten rather than moved: the claim line goes
+        if (!write_text(path("pending", ticket_name(next)), describe(next))) return false;
+        unlink(from.c_str());
+        return true;
+    }
+
+    void abandon(const WorkUnit& u) override {
+        std::string to = path("dead", claimed_name(u));
+        if (rename(path("failed", claimed_name(u)).c_str(), to.c_str()) != 0) {
+            rename(path("running", claimed_name(u)).c_str(), to.c_str());
+        }
+    }
+
+    void cancel(const std::string& id) override {
+        for (const std::string& n : list("pending")) {
+            if (n.compare(0, id.size() + 1, id + "~") == 0) unlink(path("pending", n).c_str());
+        }
+    }
+
+    std::string result_path(const std::string& id) override { return path("done", id + ".res"); }
+
+    void close() override { write_text(root + "/CLOSED", "closed\n"); }
+
+    // ---- Worker side -------------------------------------------------------
+    bool claim(const std::string& worker, WorkUnit* u) override {
+        for (const std::string& n : list("pending")) {
+            std::string to = path("running", n + "@" + worker);
+            if (rename(path("pending", n).c_str(), to.c_str()) != 0) continue;   // someone was faster
+            if (!read_unit(to, n + "@" + worker, u, NULL)) {
+                unlink(to.c_str());
+                continue;
+            }
+            FILE* f = fopen(to.c_str(), "a");
+            if (f) {
+                fprintf(f, "claimed %.3f\n", wall_seconds());
+                fclose(f);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void heartbeat(const WorkUnit& u) override { utimes(path("running", claimed_name(u)).c_str(), NULL); }
+
+    std::string scratch_path(const WorkUnit& u, const char* ext) override {
+        return path("work", claimed_name(u) + ext);
+    }
+
+    // link() rather than rename(), so a duplicate finishing second cannot
+    // replace the result the dispatcher may already have read
+    bool finish(const WorkUnit& u) override {
+        std::string res = scratch_path(u, ".res");
+        bool ok = link(res.c_str(), result_path(u.id).c_str()) == 0 || errno == EEXIST;
+        unlink(res.c_str());
+        unlink(path("running", claimed_name(u)).c_str());
+        return ok;
+    }
+
+    void fail(const WorkUnit& u) override {
+        rename(path("running", claimed_name(u)).c_str(), path("failed", claimed_name(u)).c_str());
+    }
+
+    bool closed() override { return access((root + "/CLOSED").c_str(), F_OK) == 0; }
+};
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "fifo_model.h"
+#include "tb_log.h"
+
+// =============================================================================
+// Latency Histogram - log-bucketed (HDR-style) distribution in fixed memory
+//
+// Values below 2^SUB_BITS get an exact bucket; above that every power of two
+// is split into 2^SUB_BITS linear sub-buckets, so any recorded value is
+// reported within 1/2^SUB_BITS (about 3%) of its true value. Histograms from
+// different seeds or processes merge by adding bucket counts.
+// =============================================================================
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BITS;
+    static const int NUM_BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+private:
+    uint64_t counts[NUM_BUCKETS];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t min_value;
+    uint64_t max_value;
+
+    static int bucket_index(uint64_t v) {
+        if (v < (uint64_t)SUB_BUCKETS) return (int)v;
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - SUB_BITS;
+        return (shift + 1) * SUB_BUCKETS + (int)((v >> shift) - SUB_BUCKETS);
+    }
+
+    // Smallest value that lands in bucket idx
+    static uint64_t bucket_low(int idx) {
+        if (idx < 2 * SUB_BUCKETS) return idx;
+        int shift = idx / SUB_BUCKETS - 1;
+        return (uint64_t)(idx % SUB_BUCKETS + SUB_BUCKETS) << shift;
+    }
+
+    // Largest value that lands in bucket idx
+    static uint64_t bucket_high(int idx) {
+        if (idx < 2 * SUB_BUCKETS) return idx;
+        int shift = idx / SUB_BUCKETS - 1;
+        return bucket_low(idx) + ((uint64_t)1 << shift) - 1;
+    }
+
+public:
+    LatencyHistogram() { clear(); }
+
+    void clear() {
+        for (int i = 0; i < NUM_BUCKETS; i++) counts[i] = 0;
+        total = 0;
+        sum = 0;
+        min_value = UINT64_MAX;
+        max_value = 0;
+    }
+
+    void record(uint64_t v) {
+        counts[bucket_index(v)]++;
+        total++;
+        sum += v;
+        if (v < min_value) min_value = v;
+        if (v > max_value) max_value = v;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < NUM_BUCKETS; i++) counts[i] += other.counts[i];
+        total += other.total;
+        sum += other.sum;
+        if (other.min_value < min_value) min_value = other.min_value;
+        if (other.max_value > max_value) max_value = other.max_value;
+    }
+
+    // Value at quantile q (0..1): the top of the bucket holding that rank,
+    // clamped to the largest value actually seen
+    uint64_t percentile(double q) const {
+        if (total == 0) return 0;
+        uint64_t rank = (uint64_t)(q * total + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > total) rank = total;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                uint64_t v = bucket_high(i);
+                return v < max_value ? v : max_value;
+            }
+        }
+        return max_value;
+    }
+
+    // Checkpointing: totals, then (bucket, count) for every non-empty bucket
+    void save_state(std::vector<uint64_t>& out) const {
+        out.insert(out.end(), {total, sum, min_value, max_value});
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            if (counts[i]) out.insert(out.end(), {(uint64_t)i, counts[i]});
+        }
+    }
+    bool restore_state(const uint64_t* in, size_t n) {
+        if (n < 4 || n % 2 != 0) return false;
+        clear();
+        total = in[0];
+        sum = in[1];
+        min_value = in[2];
+        max_value = in[3];
+        for (size_t k = 4; k < n; k += 2) {
+            if (in[k] >= (uint64_t)NUM_BUCKETS) return false;
+            counts[in[k]] = in[k + 1];
+        }
+        return true;
+    }
+
+    uint64_t get_count() const { return total; }
+    uint64_t get_sum() const { return sum; }
+    uint64_t get_min() const { return total ? min_value : 0; }
+    uint64_t get_max() const { return max_value; }
+};
+
+// =============================================================================
+// Latency Checker - Tracks write-to-read latency for data through the FIFO
+//
+// In-flight writes live in a preallocated power-of-two ring sized from the
+// FIFO depth, so recording and checking never touch the heap. Every failed
+// read counts as a violation; the message for it is printed at info level
+// and up (set_log_level), like the rest of a run's per-transaction output.
+// =============================================================================
+class LatencyChecker {
+private:
+    struct Transaction {
+        fifo_data_t data;
+        uint64_t write_cycle;
+    };
+    std::vector<Transaction> ring;
+    uint64_t mask;
+    uint64_t head;   // next entry to read
+    uint64_t tail;   // next entry to write
+
+    LatencyHistogram histogram;
+    uint64_t latency_violations;
+    int max_allowed_latency;
+    int log_level;
+
+    // A failed read: counted, and reported if the run's log level asks for it
+    bool violation(const char* fmt, ...) {
+        latency_violations++;
+        if (TB_LOG_MAX < TB_LOG_INFO || log_level < TB_LOG_INFO) return false;
+        va_list args;
+        va_start(args, fmt);
+        vprintf(fmt, args);
+        va_end(args);
+        return false;
+    }
+
+    // Smallest power of two that can hold every write the DUT can accept
+    // plus the one being recorded in the same cycle as a read
+    static uint64_t ring_capacity(int depth) {
+        uint64_t cap = 1;
+        while (cap < (uint64_t)depth + 1) cap <<= 1;
+        return cap;
+    }
+
+public:
+    LatencyChecker(int max_latency_cycles, int depth) :
+        ring(ring_capacity(depth)),
+        mask(ring_capacity(depth) - 1),
+        head(0),
+        tail(0),
+        latency_violations(0),
+        max_allowed_latency(max_latency_cycles),
+        log_level(TB_LOG_INFO) {}
+
+    void set_log_level(int level) { log_level = level; }
+
+    void record_write(fifo_data_t data, uint64_t cycle) {
+        if (tail - head > mask) {
+            printf("  [LATENCY ERROR] More than %llu writes in flight, dropping oldest\n",
+                   (unsigned long long)(mask + 1));
+            head++;
+        }
+        Transaction& t = ring[tail & mask];
+        t.data = data;
+        t.write_cycle = cycle;
+        tail++;
+    }
+
+    bool check_read(fifo_data_t data, uint64_t cycle) {
+        if (head == tail) return violation("  [LATENCY ERROR] Read with no pending write!\n");
+
+        const Transaction& t = ring[head & mask];
+        head++;
+
+        if (t.data != data) {
+            return violation("  [LATENCY ERROR] Data mismatch: expected %llu, got %llu\n",
+                             (unsigned long long)t.data, (unsigned long long)data);
+        }
+
+        uint64_t latency = cycle - t.write_cycle;
+        histogram.record(latency);
+
+        if (latency > (uint64_t)max_allowed_latency) {
+            return violation("  [LATENCY VIOLATION] Data %llu took %llu cycles (max: %d)\n",
+                             (unsigned long long)data, (unsigned long long)latency, max_allowed_latency);
+        }
+
+        return true;
+    }
+
+    // Fold another checker's statistics into this one (in-flight data is not merged)
+    void merge(const LatencyChecker& other) {
+        histogram.merge(other.histogram);
+        latency_violations += other.latency_violations;
+    }
+
+    void print_report() {
+        uint64_t total = histogram.get_count();
+        printf("\n========== Latency Report ==========\n");
+        printf("Total transactions: %llu\n", (unsigned long long)total);
+        if (total > 0) {
+            printf("Min latency: %llu cycles\n", (unsigned long long)histogram.get_min());
+            printf("Max latency: %llu cycles\n", (unsigned long long)histogram.get_max());
+            printf("Avg latency: %.2f cycles\n", (double)histogram.get_sum() / total);
+            printf("p50 latency: %llu cycles\n", (unsigned long long)histogram.percentile(0.50));
+            printf("p99 latency: %llu cycles\n", (unsigned long long)histogram.percentile(0.99));
+            printf("p99.9 latency: %llu cycles\n", (unsigned long long)histogram.percentile(0.999));
+        }
+        printf("Latency violations: %llu\n", (unsigned long long)latency_violations);
+        printf("Max allowed latency: %d cycles\n", max_allowed_latency);
+    }
+
+    // Checkpointing: violations, the in-flight writes (oldest first), then the histogram
+    void save_state(std::vector<uint64_t>& out) const {
+        out.assign({latency_violations, tail - head});
+        for (uint64_t k = head; k != tail; k++) {
+            out.insert(out.end(), {ring[k & mask].data, ring[k & mask].write_cycle});
+        }
+        histogram.save_state(out);
+    }
+    bool restore_state(const std::vector<uint64_t>& in) {
+        if (in.size() < 2 || in[1] > mask + 1 || in.size() < 2 + 2 * in[1]) return false;
+        latency_violations = in[0];
+        head = 0;
+        tail = 0;
+        for (uint64_t k = 0; k < in[1]; k++) record_write(in[2 + 2 * k], in[3 + 2 * k]);
+        size_t used = 2 + 2 * in[1];
+        return histogram.restore_state(in.data() + used, in.size() - used);
+    }
+
+    const LatencyHistogram& get_histogram() const { return histogram; }
+    uint64_t get_violations() { return latency_violations; }
+};
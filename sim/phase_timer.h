@@ -0,0 +1,328 @@
+#pragma once
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// =============================================================================
+// Phase timers - where the testbench hot path spends its time
+//
+// Built with -DTB_PHASES (make ... PHASES=1), TB_PHASE(id) times the rest of
+// the enclosing scope with the TSC and charges it to phase id; otherwise it
+// compiles to nothing. Phases are registered once at startup with
+// phase_register("eval") and so on, and nest: an inner phase's time is also
+// part of the outer one's.
+//
+// Optionally (phase_enable_counters()) each phase also accumulates hardware
+// counters from perf_event_open: cycles, instructions, cache misses and
+// branch misses, read with rdpmc where the kernel allows it and with read()
+// otherwise (which is far slower and perturbs short phases).
+//
+// Counts are per thread and merged when a thread exits, so worker threads
+// need no locking; forked children's counts are not collected.
+// =============================================================================
+enum { PHASE_HW_CYCLES, PHASE_HW_INSTRUCTIONS, PHASE_HW_CACHE_MISSES, PHASE_HW_BRANCH_MISSES, PHASE_HW };
+
+const int PHASE_MAX = 32;
+
+struct PhaseStats {
+    uint64_t calls;
+    uint64_t ticks;
+    uint64_t hw[PHASE_HW];
+};
+
+inline uint64_t phase_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+namespace phase_detail {
+
+// Registry and totals shared by every thread
+struct Global {
+    std::mutex lock;
+    std::vector<std::string> names;
+    PhaseStats totals[PHASE_MAX];
+    bool counters;               // hardware counters requested
+    std::string counter_error;   // why they are not available, if they are not
+    uint64_t start_ticks;
+    std::chrono::steady_clock::time_point start_time;
+
+    Global() : totals(), counters(false), start_ticks(phase_ticks()),
+               start_time(std::chrono::steady_clock::now()) {}
+};
+
+inline Global& global() {
+    static Global g;
+    return g;
+}
+
+#if defined(__linux__)
+// One counting event for this thread, readable from user space if possible
+struct HwCounter {
+    int fd;
+    perf_event_mmap_page* page;
+
+    HwCounter() : fd(-1), page(NULL) {}
+
+    bool open(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd < 0) return false;
+        void* p = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fd, 0);
+        page = p == MAP_FAILED ? NULL : (perf_event_mmap_page*)p;
+        return true;
+    }
+
+    void close_fd() {
+        if (page) munmap(page, sysconf(_SC_PAGESIZE));
+        if (fd >= 0) close(fd);
+        fd = -1;
+        page = NULL;
+    }
+
+    uint64_t read_count() const {
+#if defined(__x86_64__) || defined(__i386__)
+        if (page) {
+            uint64_t count;
+            uint32_t seq;
+            bool ok;
+            do {
+                seq = page->lock;
+                __asm__ __volatile__("" ::: "memory");
+                uint32_t idx = page->index;
+                ok = page->cap_user_rdpmc && idx;
+                count = page->offset;
+                if (ok) {
+                    int shift = 64 - page->pmc_width;
+                    count += (uint64_t)(((int64_t)__rdpmc(idx - 1) << shift) >> shift);
+                }
+                __asm__ __volatile__("" ::: "memory");
+            } while (page->lock != seq);
+            if (ok) return count;
+        }
+#endif
+        uint64_t value = 0;
+        if (read(fd, &value, sizeof(value)) != sizeof(value)) return 0;
+        return value;
+    }
+};
+#endif
+
+// This thread's counts, merged into the totals when the thread exits
+struct Local {
+    PhaseStats stats[PHASE_MAX];
+#if defined(__linux__)
+    HwCounter hw[PHASE_HW];
+#endif
+    bool hw_open;
+
+    Local() : stats(), hw_open(false) {
+#if defined(__linux__)
+        Global& g = global();
+        if (!g.counters) return;
+        static const uint64_t configs[PHASE_HW] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                   PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        hw_open = true;
+        for (int i = 0; i < PHASE_HW && hw_open; i++) hw_open = hw[i].open(PERF_TYPE_HARDWARE, configs[i]);
+        if (!hw_open) {
+            std::lock_guard<std::mutex> guard(g.lock);
+            if (g.counter_error.empty()) g.counter_error = strerror(errno);
+            for (int i = 0; i < PHASE_HW; i++) hw[i].close_fd();
+        }
+#endif
+    }
+
+    ~Local() {
+        merge_into(global().totals);
+#if defined(__linux__)
+        for (int i = 0; i < PHASE_HW; i++) hw[i].close_fd();
+#endif
+    }
+
+    void merge_into(PhaseStats* totals) {
+        std::lock_guard<std::mutex> guard(global().lock);
+        for (int p = 0; p < PHASE_MAX; p++) {
+            totals[p].calls += stats[p].calls;
+            totals[p].ticks += stats[p].ticks;
+            for (int i = 0; i < PHASE_HW; i++) totals[p].hw[i] += stats[p].hw[i];
+            stats[p] = PhaseStats();
+        }
+    }
+
+    void read_hw(uint64_t* out) const {
+#if defined(__linux__)
+        for (int i = 0; i < PHASE_HW; i++) out[i] = hw[i].read_count();
+#else
+        (void)out;
+#endif
+    }
+};
+
+inline Local& local() {
+    thread_local Local l;
+    return l;
+}
+
+}  // namespace phase_detail
+
+// Register a phase by name (before any threads start); returns its id
+inline int phase_register(const char* name) {
+    phase_detail::Global& g = phase_detail::global();
+    std::lock_guard<std::mutex> guard(g.lock);
+    for (size_t i = 0; i < g.names.size(); i++) {
+        if (g.names[i] == name) return (int)i;
+    }
+    if ((int)g.names.size() == PHASE_MAX) return PHASE_MAX - 1;
+    g.names.push_back(name);
+    return (int)g.names.size() - 1;
+}
+
+// Ask for hardware counters too; call before the first timed phase
+inline void phase_enable_counters() { phase_detail::global().counters = true; }
+
+// Times its scope (see TB_PHASE)
+class PhaseScope {
+private:
+    phase_detail::Local& l;
+    int id;
+    uint64_t start;
+    uint64_t hw_start[PHASE_HW];
+
+public:
+    explicit PhaseScope(int phase) : l(phase_detail::local()), id(phase) {
+        if (l.hw_open) l.read_hw(hw_start);
+        start = phase_ticks();
+    }
+
+    ~PhaseScope() {
+        uint64_t end = phase_ticks();
+        PhaseStats& s = l.stats[id];
+        s.calls++;
+        s.ticks += end - start;
+        if (l.hw_open) {
+            uint64_t hw_end[PHASE_HW];
+            l.read_hw(hw_end);
+            for (int i = 0; i < PHASE_HW; i++) s.hw[i] += hw_end[i] - hw_start[i];
+        }
+    }
+};
+
+#ifdef TB_PHASES
+#define TB_PHASE_CAT2(a, b) a##b
+#define TB_PHASE_CAT(a, b) TB_PHASE_CAT2(a, b)
+#define TB_PHASE(id) PhaseScope TB_PHASE_CAT(tb_phase_, __LINE__)(id)
+#else
+#define TB_PHASE(id) ((void)0)
+#endif
+
+// =============================================================================
+// Reporting - totals of every thread that has exited plus the calling one
+// =============================================================================
+struct PhaseReport {
+    std::vector<std::string> names;
+    std::vector<PhaseStats> stats;
+    double wall_seconds;
+    double ticks_per_ns;        // TSC rate, calibrated against the wall clock
+    bool counters;              // stats include hardware counters
+    std::string counter_error;  // requested but unavailable
+
+    double seconds(const PhaseStats& s) const { return s.ticks / ticks_per_ns * 1e-9; }
+};
+
+inline PhaseReport phase_report() {
+    phase_detail::Global& g = phase_detail::global();
+    phase_detail::Local& l = phase_detail::local();
+    l.merge_into(g.totals);
+
+    PhaseReport r;
+    std::lock_guard<std::mutex> guard(g.lock);
+    r.names = g.names;
+    r.stats.assign(g.totals, g.totals + g.names.size());
+    r.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - g.start_time).count();
+    double ns = r.wall_seconds * 1e9;
+    r.ticks_per_ns = ns > 0 ? (phase_ticks() - g.start_ticks) / ns : 1;
+    if (r.ticks_per_ns <= 0) r.ticks_per_ns = 1;
+    r.counters = g.counters && g.counter_error.empty();
+    r.counter_error = g.counter_error;
+    return r;
+}
+
+// Per-phase breakdown table
+inline void phase_print(const PhaseReport& r, FILE* out = stdout) {
+    fprintf(out, "\n========== Phase Breakdown ==========\n");
+    fprintf(out, "%-12s %12s %10s %12s %7s", "phase", "calls", "seconds", "ns/call", "%wall");
+    if (r.counters) fprintf(out, " %8s %8s %10s %10s", "cyc/call", "IPC", "cache-miss", "br-miss");
+    fprintf(out, "\n");
+    for (size_t p = 0; p < r.names.size(); p++) {
+        const PhaseStats& s = r.stats[p];
+        if (s.calls == 0) continue;
+        double sec = r.seconds(s);
+        fprintf(out, "%-12s %12llu %10.4f %12.1f %6.1f%%", r.names[p].c_str(), (unsigned long long)s.calls,
+                sec, sec * 1e9 / s.calls, r.wall_seconds > 0 ? 100 * sec / r.wall_seconds : 0.0);
+        if (r.counters) {
+            const uint64_t* hw = s.hw;
+            fprintf(out, " %8.1f %8.2f %10llu %10llu", (double)hw[PHASE_HW_CYCLES] / s.calls,
+                    hw[PHASE_HW_CYCLES] ? (double)hw[PHASE_HW_INSTRUCTIONS] / hw[PHASE_HW_CYCLES] : 0.0,
+                    (unsigned long long)hw[PHASE_HW_CACHE_MISSES],
+                    (unsigned long long)hw[PHASE_HW_BRANCH_MISSES]);
+        }
+        fprintf(out, "\n");
+    }
+    fprintf(out, "Wall time: %.4f s (nested phases are included in their parents)\n", r.wall_seconds);
+    if (!r.counter_error.empty()) fprintf(out, "Hardware counters unavailable: %s\n", r.counter_error.c_str());
+}
+
+// The same breakdown as JSON ("-" for stdout)
+inline bool phase_write_json(const PhaseReport& r, const char* path, const char* testbench) {
+    FILE* f = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "{\n  \"testbench\": \"%s\",\n  \"wall_seconds\": %.6f,\n  \"tsc_ticks_per_ns\": %.4f,\n",
+            testbench, r.wall_seconds, r.ticks_per_ns);
+    fprintf(f, "  \"hw_counters\": %s,\n  \"phases\": [", r.counters ? "true" : "false");
+    bool first = true;
+    for (size_t p = 0; p < r.names.size(); p++) {
+        const PhaseStats& s = r.stats[p];
+        if (s.calls == 0) continue;
+        double sec = r.seconds(s);
+        fprintf(f, "%s\n    {\"name\": \"%s\", \"calls\": %llu, \"seconds\": %.6f, \"ns_per_call\": %.2f",
+                first ? "" : ",", r.names[p].c_str(), (unsigned long long)s.calls, sec, sec * 1e9 / s.calls);
+        if (r.counters) {
+            fprintf(f, ", \"cycles\": %llu, \"instructions\": %llu, \"cache_misses\": %llu, \"branch_misses\": %llu",
+                    (unsigned long long)s.hw[PHASE_HW_CYCLES], (unsigned long long)s.hw[PHASE_HW_INSTRUCTIONS],
+                    (unsigned long long)s.hw[PHASE_HW_CACHE_MISSES],
+                    (unsigned long long)s.hw[PHASE_HW_BRANCH_MISSES]);
+        }
+        fprintf(f, "}");
+        first = false;
+    }
+    fprintf(f, "\n  ]\n}\n");
+    bool ok = !ferror(f);
+    if (f != stdout) ok = fclose(f) == 0 && ok;
+    return ok;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define PRNG_HAVE_AVX2 1
+#endif
+
+// =============================================================================
+// Random number generation for the testbenches
+//
+// xoshiro256** (Blackman & Vigna): 256 bits of state, a few shifts and adds
+// per output and good statistical quality. Generators are seeded from a
+// (seed, stream) pair through SplitMix64, so every seed gets independent,
+// reproducible streams for each thing it randomizes, on any thread.
+// =============================================================================
+
+inline uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+class Xoshiro256 {
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+    // Usable wherever the standard library wants a random bit generator
+    typedef uint64_t result_type;
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+
+    explicit Xoshiro256(uint64_t seed, uint64_t stream = 0) {
+        uint64_t x = seed ^ splitmix64(stream);
+        for (int i = 0; i < 4; i++) s[i] = splitmix64(x);
+    }
+
+    uint64_t operator()() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Advance by 2^128 outputs: repeated jumps give non-overlapping sub-streams
+    void jump() {
+        static const uint64_t JUMP[4] = {0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+                                         0xa9582618e03fc9aaull, 0x39abdc4529b1661cull};
+        uint64_t j[4] = {0, 0, 0, 0};
+        for (int w = 0; w < 4; w++) {
+            for (int b = 0; b < 64; b++) {
+                if (JUMP[w] & (1ull << b)) {
+                    for (int i = 0; i < 4; i++) j[i] ^= s[i];
+                }
+                (*this)();
+            }
+        }
+        for (int i = 0; i < 4; i++) s[i] = j[i];
+    }
+
+    uint64_t state(int i) const { return s[i]; }
+
+    // Checkpointing: the four state words
+    void save_state(std::vector<uint64_t>& out) const { out.assign(s, s + 4); }
+    bool restore_state(const std::vector<uint64_t>& in) {
+        if (in.size() != 4) return false;
+        for (int i = 0; i < 4; i++) s[i] = in[i];
+        return true;
+    }
+};
+
+// =============================================================================
+// Xoshiro256x4 - four xoshiro256** lanes (one generator, jumped 0..3 times)
+// stepped together, for filling whole blocks of random words in one pass.
+// Output i comes from lane i % 4. The AVX2 and scalar paths produce the same
+// words, so a seed reproduces on any machine.
+// =============================================================================
+class Xoshiro256x4 {
+private:
+    uint64_t s[4][4];   // s[word][lane], so each word loads as one vector
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    void fill_scalar(uint64_t* out, size_t n, uint64_t mask) {
+        for (size_t i = 0; i < n; i += 4) {
+            for (int l = 0; l < 4; l++) {
+                uint64_t result = rotl(s[1][l] * 5, 7) * 9;
+                uint64_t t = s[1][l] << 17;
+                s[2][l] ^= s[0][l];
+                s[3][l] ^= s[1][l];
+                s[1][l] ^= s[2][l];
+                s[0][l] ^= s[3][l];
+                s[2][l] ^= t;
+                s[3][l] = rotl(s[3][l], 45);
+                out[i + l] = result & mask;
+            }
+        }
+    }
+
+#ifdef PRNG_HAVE_AVX2
+    // No 64-bit vector multiply in AVX2, but *5 and *9 are a shift and an add
+    __attribute__((target("avx2")))
+    void fill_avx2(uint64_t* out, size_t n, uint64_t mask) {
+        __m256i s0 = _mm256_loadu_si256((const __m256i*)s[0]);
+        __m256i s1 = _mm256_loadu_si256((const __m256i*)s[1]);
+        __m256i s2 = _mm256_loadu_si256((const __m256i*)s[2]);
+        __m256i s3 = _mm256_loadu_si256((const __m256i*)s[3]);
+        const __m256i m = _mm256_set1_epi64x((long long)mask);
+
+        for (size_t i = 0; i < n; i += 4) {
+            __m256i x = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+            x = _mm256_or_si256(_mm256_slli_epi64(x, 7), _mm256_srli_epi64(x, 57));
+            x = _mm256_add_epi64(_mm256_slli_epi64(x, 3), x);
+            _mm256_storeu_si256((__m256i*)(out + i), _mm256_and_si256(x, m));
+
+            __m256i t = _mm256_slli_epi64(s1, 17);
+            s2 = _mm256_xor_si256(s2, s0);
+            s3 = _mm256_xor_si256(s3, s1);
+            s1 = _mm256_xor_si256(s1, s2);
+            s0 = _mm256_xor_si256(s0, s3);
+            s2 = _mm256_xor_si256(s2, t);
+            s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+        }
+
+        _mm256_storeu_si256((__m256i*)s[0], s0);
+        _mm256_storeu_si256((__m256i*)s[1], s1);
+        _mm256_storeu_si256((__m256i*)s[2], s2);
+        _mm256_storeu_si256((__m256i*)s[3], s3);
+    }
+#endif
+
+public:
+    explicit Xoshiro256x4(uint64_t seed, uint64_t stream = 0) {
+        Xoshiro256 g(seed, stream);
+        for (int l = 0; l < 4; l++) {
+            for (int w = 0; w < 4; w++) s[w][l] = g.state(w);
+            g.jump();
+        }
+    }
+
+    // Write n random words ANDed with mask. out must have room for n rounded
+    // up to a multiple of 4; the words past n are generated and discarded.
+    void fill(uint64_t* out, size_t n, uint64_t mask = UINT64_MAX) {
+#ifdef PRNG_HAVE_AVX2
+        static const bool have_avx2 = __builtin_cpu_supports("avx2");
+        if (have_avx2) {
+            fill_avx2(out, n, mask);
+            return;
+        }
+#endif
+        fill_scalar(out, n, mask);
+    }
+
+    // Checkpointing: all sixteen state words
+    void save_state(std::vector<uint64_t>& out) const { out.assign(&s[0][0], &s[0][0] + 16); }
+    bool restore_state(const std::vector<uint64_t>& in) {
+        if (in.size() != 16) return false;
+        for (int i = 0; i < 16; i++) s[i / 4][i % 4] = in[i];
+        return true;
+    }
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "coverage.h"
+#include "latency_checker.h"
+
+// =============================================================================
+// Result records - what one testbench run hands back to the regression
+// dispatcher (tb_fifo --result FILE, read by sim/dispatch)
+//
+// Compact and self-contained, so the dispatcher merges records from any
+// number of runs and hosts without the testbench's build: every seed's
+// outcome in a fixed-size record, the latency histogram's buckets and the
+// coverage database. File layout (little-endian):
+//   "RTLRES01"  u32 version  u32 depth  u32 data width  u32 seeds
+//   f64 run seconds  u64 cycles the assertion monitors checked
+//   seeds x ResultSeed
+//   u64 N, then N words of latency histogram (LatencyHistogram::save_state)
+//   coverage database (CoverGroup::save)
+// =============================================================================
+
+struct ResultSeed {
+    uint64_t seed;
+    int32_t cycles;
+    int32_t closure_cycle;   // -1 if the coverage target was not reached
+    uint32_t mismatches;
+    uint32_t latency_violations;
+    uint32_t assertion_failures;
+    uint32_t writes;
+    uint32_t reads;
+    uint32_t _pad;
+
+    bool failed() const { return mismatches + latency_violations + assertion_failures > 0; }
+};
+static_assert(sizeof(ResultSeed) == 40, "result seed records are 40 bytes");
+
+struct ResultHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t depth;
+    uint32_t data_width;
+    uint32_t seeds;
+    double seconds;
+    uint64_t assertion_cycles;
+};
+static_assert(sizeof(ResultHeader) == 40, "result header is 40 bytes");
+
+const uint32_t RESULT_VERSION = 1;
+
+class RunResult {
+public:
+    uint32_t depth;
+    uint32_t data_width;
+    double seconds;
+    uint64_t assertion_cycles;
+    std::vector<ResultSeed> seeds;
+    LatencyHistogram latency;
+    CoverGroup coverage;
+
+    RunResult() : depth(0), data_width(0), seconds(0), assertion_cycles(0) {}
+
+    bool write(const char* path) {
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        ResultHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, "RTLRES01", 8);
+        hdr.version = RESULT_VERSION;
+        hdr.depth = depth;
+        hdr.data_width = data_width;
+        hdr.seeds = (uint32_t)seeds.size();
+        hdr.seconds = seconds;
+        hdr.assertion_cycles = assertion_cycles;
+        fwrite(&hdr, sizeof(hdr), 1, f);
+        fwrite(seeds.data(), sizeof(ResultSeed), seeds.size(), f);
+
+        std::vector<uint64_t> words;
+        latency.save_state(words);
+        uint64_t n = words.size();
+        fwrite(&n, sizeof(n), 1, f);
+        fwrite(words.data(), sizeof(uint64_t), words.size(), f);
+        bool ok = coverage.save(f);
+        return fclose(f) == 0 && ok;
+    }
+
+    // false (with the reason in error) if path is not a complete result record
+    bool read(const char* path, const char** error) {
+        *error = NULL;
+        FILE* f = fopen(path, "rb");
+        if (!f) {
+            *error = "cannot open";
+            return false;
+        }
+        ResultHeader hdr;
+        uint64_t n = 0;
+        std::vector<uint64_t> words;
+        if (fread(&hdr, sizeof(hdr), 1, f) != 1 || memcmp(hdr.magic, "RTLRES01", 8) != 0 ||
+            hdr.version != RESULT_VERSION) {
+            *error = "not a result record (or a different version)";
+        } else {
+            seeds.resize(hdr.seeds);
+            if (fread(seeds.data(), sizeof(ResultSeed), seeds.size(), f) != seeds.size() ||
+                fread(&n, sizeof(n), 1, f) != 1 || n > (1u << 20)) {
+                *error = "truncated";
+            } else {
+                words.resize(n);
+                if (fread(words.data(), sizeof(uint64_t), n, f) != n ||
+                    !latency.restore_state(words.data(), n)) {
+                    *error = "bad latency histogram";
+                } else if (!coverage.load(f)) {
+                    *error = "bad coverage database";
+                }
+            }
+        }
+        fclose(f);
+        if (*error) return false;
+
+        depth = hdr.depth;
+        data_width = hdr.data_width;
+        seconds = hdr.seconds;
+        assertion_cycles = hdr.assertion_cycles;
+        return true;
+    }
+
+    // Add another run of the same configuration; false if it is not one
+    bool merge(const RunResult& other) {
+        if (seeds.empty() && depth == 0) {
+            *this = other;
+            return true;
+        }
+        if (other.depth != depth || other.data_width != data_width || !coverage.merge(other.coverage)) {
+            return false;
+        }
+        seconds += other.seconds;
+        assertion_cycles += other.assertion_cycles;
+        seeds.insert(seeds.end(), other.seeds.begin(), other.seeds.end());
+        latency.merge(other.latency);
+        return true;
+    }
+};
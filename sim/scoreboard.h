@@ -0,0 +1,159 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "fifo_model.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SCOREBOARD_HAVE_AVX2 1
+#endif
+
+// =============================================================================
+// FifoOutputs - structure-of-arrays capture of the FIFO outputs, one entry per
+// cycle, for either the DUT or the reference model
+// =============================================================================
+class FifoOutputs {
+private:
+    std::vector<uint64_t> data_out;
+    std::vector<uint32_t> count;
+    std::vector<uint8_t>  full;
+    std::vector<uint8_t>  empty;
+
+public:
+    explicit FifoOutputs(size_t cycles) :
+        data_out(cycles), count(cycles), full(cycles), empty(cycles) {}
+
+    // Raw stream pointers, as filled by FifoModel::step_batch
+    FifoOutBuf buf() {
+        FifoOutBuf b = {data_out.data(), count.data(), full.data(), empty.data()};
+        return b;
+    }
+
+    const uint64_t* data_out_stream() const { return data_out.data(); }
+    const uint32_t* count_stream() const { return count.data(); }
+    const uint8_t*  full_stream() const { return full.data(); }
+    const uint8_t*  empty_stream() const { return empty.data(); }
+
+    void set(size_t i, const FifoOut& o) {
+        data_out[i] = o.data_out;
+        count[i] = o.count;
+        full[i] = o.full;
+        empty[i] = o.empty;
+    }
+
+    FifoOut at(size_t i) const {
+        FifoOut o = {};
+        o.data_out = data_out[i];
+        o.count = count[i];
+        o.full = full[i];
+        o.empty = empty[i];
+        return o;
+    }
+};
+
+// =============================================================================
+// Scoreboard comparison kernel
+//
+// Compares n cycles of RTL vs reference outputs and sets bit (i % 64) of
+// mismatch[i / 64] for every cycle i where full, empty or count differ, or
+// data_out differs while the RTL is not empty. The bitmap must hold
+// (n + 63) / 64 words. Returns the number of mismatching cycles; only those
+// need to be looked at again for diagnostics.
+// =============================================================================
+
+// Cycles [begin, n) one at a time, branch-free; begin must be a multiple of 64
+inline size_t scoreboard_compare_scalar(const FifoOutputs& rtl, const FifoOutputs& ref,
+                                        size_t begin, size_t n, uint64_t* mismatch) {
+    const uint64_t* rd = rtl.data_out_stream();
+    const uint64_t* md = ref.data_out_stream();
+    const uint32_t* rc = rtl.count_stream();
+    const uint32_t* mc = ref.count_stream();
+    const uint8_t*  rf = rtl.full_stream();
+    const uint8_t*  mf = ref.full_stream();
+    const uint8_t*  re = rtl.empty_stream();
+    const uint8_t*  me = ref.empty_stream();
+
+    size_t flagged = 0;
+    for (size_t base = begin; base < n; base += 64) {
+        size_t len = n - base < 64 ? n - base : 64;
+        uint64_t bits = 0;
+        for (size_t j = 0; j < len; j++) {
+            size_t i = base + j;
+            uint64_t bad = (uint64_t)(rf[i] != mf[i]) | (re[i] != me[i]) | (rc[i] != mc[i]) |
+                           ((rd[i] != md[i]) & (re[i] == 0));
+            bits |= bad << j;
+        }
+        mismatch[base / 64] = bits;
+        flagged += __builtin_popcountll(bits);
+    }
+    return flagged;
+}
+
+#ifdef SCOREBOARD_HAVE_AVX2
+// 64 cycles per block: flags 32 lanes at a time, count 8 lanes, data_out 4 lanes
+__attribute__((target("avx2")))
+inline size_t scoreboard_compare_avx2(const FifoOutputs& rtl, const FifoOutputs& ref,
+                                      size_t n, uint64_t* mismatch) {
+    const uint64_t* rd = rtl.data_out_stream();
+    const uint64_t* md = ref.data_out_stream();
+    const uint32_t* rc = rtl.count_stream();
+    const uint32_t* mc = ref.count_stream();
+    const uint8_t*  rf = rtl.full_stream();
+    const uint8_t*  mf = ref.full_stream();
+    const uint8_t*  re = rtl.empty_stream();
+    const uint8_t*  me = ref.empty_stream();
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t flagged = 0;
+    size_t base = 0;
+    for (; base + 64 <= n; base += 64) {
+        uint64_t flags_eq = 0;    // full and empty both match
+        uint64_t not_empty = 0;   // RTL not empty, so data_out is checked
+        for (int k = 0; k < 2; k++) {
+            size_t o = base + 32 * k;
+            __m256i r_empty = _mm256_loadu_si256((const __m256i*)(re + o));
+            __m256i f = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(rf + o)),
+                                          _mm256_loadu_si256((const __m256i*)(mf + o)));
+            __m256i e = _mm256_cmpeq_epi8(r_empty, _mm256_loadu_si256((const __m256i*)(me + o)));
+            flags_eq |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_and_si256(f, e)) << (32 * k);
+            not_empty |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(r_empty, zero))
+                         << (32 * k);
+        }
+
+        uint64_t count_eq = 0;
+        for (int k = 0; k < 8; k++) {
+            size_t o = base + 8 * k;
+            __m256i c = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(rc + o)),
+                                           _mm256_loadu_si256((const __m256i*)(mc + o)));
+            count_eq |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(c)) << (8 * k);
+        }
+
+        uint64_t data_eq = 0;
+        for (int k = 0; k < 16; k++) {
+            size_t o = base + 4 * k;
+            __m256i d = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(rd + o)),
+                                           _mm256_loadu_si256((const __m256i*)(md + o)));
+            data_eq |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(d)) << (4 * k);
+        }
+
+        uint64_t bits = ~(flags_eq & count_eq) | (~data_eq & not_empty);
+        mismatch[base / 64] = bits;
+        flagged += __builtin_popcountll(bits);
+    }
+
+    // Tail shorter than one block
+    return flagged + scoreboard_compare_scalar(rtl, ref, base, n, mismatch);
+}
+#endif
+
+// Picks the widest kernel the CPU supports at runtime
+inline size_t scoreboard_compare(const FifoOutputs& rtl, const FifoOutputs& ref,
+                                 size_t n, uint64_t* mismatch) {
+#ifdef SCOREBOARD_HAVE_AVX2
+    static const bool have_avx2 = __builtin_cpu_supports("avx2");
+    if (have_avx2) return scoreboard_compare_avx2(rtl, ref, n, mismatch);
+#endif
+    return scoreboard_compare_scalar(rtl, ref, 0, n, mismatch);
+}
@@ -0,0 +1,313 @@
+// Convert captured input streams (CSV or VCD) into a stimulus file the
+// testbenches replay with --replay, or describe an existing one.
+//
+// usage: stim_convert IN.csv|IN.vcd -o OUT.stim [--layout fifo|counter]
+//                     [--clock NAME] [--map FIELD=NAME ...]
+//        stim_convert --info FILE.stim
+//
+// The inputs of the layout (fifo: rst_n wr_en rd_en data_in, counter: rst_n
+// enable) are looked up by name; --map FIELD=NAME reads one under another
+// name. A missing rst_n is taken as released, any other missing input as 0.
+//
+// CSV: a header line naming the columns, then one line per cycle. With a
+// "cycle" column, lines may skip cycles (inputs hold their values) and the
+// first line's cycle is the file's first cycle. Values are decimal or 0x hex.
+//
+// VCD: one record per rising edge of the clock (default "clk"), holding the
+// values the inputs had just before that edge. Signals match on their
+// reference name in any scope (the first one declared wins); x and z read as 0.
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "stim_file.h"
+
+enum { F_RST_N, F_WR_EN, F_RD_EN, F_DATA_IN, F_ENABLE, NUM_FIELDS };
+const char* FIELD_NAMES[NUM_FIELDS] = {"rst_n", "wr_en", "rd_en", "data_in", "enable"};
+
+struct Options {
+    const char* in;
+    const char* out;
+    StimLayout layout;
+    const char* clock;
+    std::string names[NUM_FIELDS];   // signal or column to read each field from
+};
+
+bool field_used(const Options& o, int f) {
+    if (o.layout == STIM_COUNTER) return f == F_RST_N || f == F_ENABLE;
+    return f != F_ENABLE;
+}
+
+// Pack one cycle's field values (missing fields already defaulted)
+StimRecord make_record(const Options& o, const uint64_t* v) {
+    StimRecord r = {};
+    r.rst_n = v[F_RST_N] != 0;
+    if (o.layout == STIM_COUNTER) {
+        r.en[0] = v[F_ENABLE] != 0;
+    } else {
+        r.data = v[F_DATA_IN];
+        r.en[0] = v[F_WR_EN] != 0;
+        r.en[1] = v[F_RD_EN] != 0;
+    }
+    return r;
+}
+
+void init_values(uint64_t* v) {
+    for (int f = 0; f < NUM_FIELDS; f++) v[f] = 0;
+    v[F_RST_N] = 1;
+}
+
+// =============================================================================
+// CSV
+// =============================================================================
+std::vector<std::string> split_csv(const char* line) {
+    std::vector<std::string> cols(1);
+    for (const char* p = line; *p && *p != '\n' && *p != '\r'; p++) {
+        if (*p == ',') {
+            cols.emplace_back();
+        } else if (!isspace((unsigned char)*p)) {
+            cols.back() += *p;
+        }
+    }
+    return cols;
+}
+
+bool convert_csv(const Options& o, FILE* in, StimWriter& out, uint32_t* width) {
+    char line[4096];
+    std::vector<std::string> header;
+    while (header.empty() && fgets(line, sizeof(line), in)) {
+        if (line[0] != '#' && line[0] != '\n') header = split_csv(line);
+    }
+
+    int column[NUM_FIELDS];
+    int cycle_col = -1;
+    for (int f = 0; f < NUM_FIELDS; f++) column[f] = -1;
+    for (size_t c = 0; c < header.size(); c++) {
+        if (header[c] == "cycle") cycle_col = (int)c;
+        for (int f = 0; f < NUM_FIELDS; f++) {
+            if (field_used(o, f) && header[c] == o.names[f]) column[f] = (int)c;
+        }
+    }
+    for (int f = 0; f < NUM_FIELDS; f++) {
+        if (field_used(o, f) && column[f] < 0) {
+            fprintf(stderr, "stim_convert: no column %s, using %s\n", o.names[f].c_str(), f == F_RST_N ? "1" : "0");
+        }
+    }
+
+    uint64_t v[NUM_FIELDS];
+    init_values(v);
+    uint64_t next_cycle = 0;
+    long line_no = 1;
+    bool opened = false;
+    while (fgets(line, sizeof(line), in)) {
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+        std::vector<std::string> cols = split_csv(line);
+        uint64_t cycle = cycle_col >= 0 && cycle_col < (int)cols.size()
+                             ? strtoull(cols[cycle_col].c_str(), NULL, 0) : next_cycle;
+        if (!opened) {
+            if (!out.open(o.out, o.layout, 0, cycle)) return false;
+            next_cycle = cycle;
+            opened = true;
+        }
+        if (cycle < next_cycle) {
+            fprintf(stderr, "stim_convert: line %ld goes back to cycle %llu\n", line_no, (unsigned long long)cycle);
+            return false;
+        }
+        // Skipped cycles repeat the previous inputs
+        for (; next_cycle < cycle; next_cycle++) out.add(make_record(o, v));
+
+        for (int f = 0; f < NUM_FIELDS; f++) {
+            if (column[f] >= 0 && column[f] < (int)cols.size()) {
+                v[f] = strtoull(cols[column[f]].c_str(), NULL, 0);
+            }
+        }
+        while (*width < 64 && v[F_DATA_IN] >> *width) (*width)++;
+        out.add(make_record(o, v));
+        next_cycle++;
+    }
+    if (!opened) return out.open(o.out, o.layout, 0, 0);
+    out.set_data_width(*width);
+    return true;
+}
+
+// =============================================================================
+// VCD
+// =============================================================================
+
+// Next whitespace-separated token, false at end of file
+bool next_token(FILE* in, std::string& tok) {
+    tok.clear();
+    int c;
+    while ((c = fgetc(in)) != EOF && isspace(c)) {}
+    while (c != EOF && !isspace(c)) {
+        tok += (char)c;
+        c = fgetc(in);
+    }
+    return !tok.empty();
+}
+
+// "b1x01" (or a scalar "1"/"x") to a number, x and z as 0
+uint64_t vcd_value(const char* bits) {
+    uint64_t v = 0;
+    for (const char* p = bits; *p; p++) v = (v << 1) | (*p == '1');
+    return v;
+}
+
+bool convert_vcd(const Options& o, FILE* in, StimWriter& out, uint32_t* width) {
+    // Identifier code of each field and of the clock, from the declarations
+    std::unordered_map<std::string, int> ids;   // code -> field, NUM_FIELDS for the clock
+    bool found[NUM_FIELDS + 1] = {};
+    std::string tok;
+    while (next_token(in, tok) && tok != "$enddefinitions") {
+        if (tok != "$var") continue;
+        std::string type, size, code, name;
+        next_token(in, type);
+        next_token(in, size);
+        next_token(in, code);
+        next_token(in, name);
+        for (int f = 0; f <= NUM_FIELDS; f++) {
+            const std::string& want = f == NUM_FIELDS ? std::string(o.clock) : o.names[f];
+            if (found[f] || name != want || (f < NUM_FIELDS && !field_used(o, f))) continue;
+            ids[code] = f;
+            found[f] = true;
+            if (f == F_DATA_IN) *width = (uint32_t)atoi(size.c_str());
+        }
+    }
+    if (!found[NUM_FIELDS]) {
+        fprintf(stderr, "stim_convert: no clock signal %s in the VCD (use --clock)\n", o.clock);
+        return false;
+    }
+    for (int f = 0; f < NUM_FIELDS; f++) {
+        if (field_used(o, f) && !found[f]) {
+            fprintf(stderr, "stim_convert: no signal %s, using %s\n", o.names[f].c_str(), f == F_RST_N ? "1" : "0");
+        }
+    }
+    if (!out.open(o.out, o.layout, *width > 64 ? 64 : *width, 0)) return false;
+
+    // Values as of the last timestamp, and as they were before it: a rising
+    // edge during a time step samples the inputs from before that step
+    uint64_t now[NUM_FIELDS + 1], before[NUM_FIELDS + 1];
+    init_values(now);
+    now[NUM_FIELDS] = 0;
+    memcpy(before, now, sizeof(now));
+
+    auto end_step = [&]() {
+        if (!before[NUM_FIELDS] && now[NUM_FIELDS]) out.add(make_record(o, before));
+        memcpy(before, now, sizeof(now));
+    };
+    auto change = [&](const std::string& code, uint64_t value) {
+        auto it = ids.find(code);
+        if (it != ids.end()) now[it->second] = value;
+    };
+
+    while (next_token(in, tok)) {
+        char c = tok[0];
+        if (c == '#') {
+            end_step();
+        } else if (c == '$') {
+            // $dumpvars/$end and friends only bracket value changes; skip comments
+            if (tok == "$comment") {
+                while (next_token(in, tok) && tok != "$end") {}
+            }
+        } else if (c == 'b' || c == 'B') {
+            std::string code;
+            next_token(in, code);
+            change(code, vcd_value(tok.c_str() + 1));
+        } else if (c == 'r' || c == 'R') {
+            std::string code;
+            next_token(in, code);   // real values are not inputs of these designs
+        } else {
+            change(tok.substr(1), c == '1');
+        }
+    }
+    end_step();
+    return true;
+}
+
+// =============================================================================
+// --info
+// =============================================================================
+int print_info(const char* path) {
+    StimReplay stim;
+    const char* error;
+    if (!stim.open(path, &error)) {
+        fprintf(stderr, "stim_convert: %s: %s\n", path, error);
+        return 1;
+    }
+    printf("%s: %s layout, data width %u\n", path, stim_layout_name(stim.layout()), stim.data_width());
+    printf("  cycles %llu..%llu (%llu records)\n", (unsigned long long)stim.first_cycle(),
+           (unsigned long long)(stim.first_cycle() + stim.size() - (stim.size() > 0)),
+           (unsigned long long)stim.size());
+    printf("  %llu reset points to seek to\n", (unsigned long long)stim.reset_points());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    o.in = NULL;
+    o.out = NULL;
+    o.layout = STIM_FIFO;
+    o.clock = "clk";
+    for (int f = 0; f < NUM_FIELDS; f++) o.names[f] = FIELD_NAMES[f];
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--info") == 0 && i + 1 < argc) {
+            return print_info(argv[i + 1]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            o.out = argv[++i];
+        } else if (strcmp(argv[i], "--clock") == 0 && i + 1 < argc) {
+            o.clock = argv[++i];
+        } else if (strcmp(argv[i], "--layout") == 0 && i + 1 < argc) {
+            const char* l = argv[++i];
+            if (strcmp(l, "fifo") == 0) {
+                o.layout = STIM_FIFO;
+            } else if (strcmp(l, "counter") == 0) {
+                o.layout = STIM_COUNTER;
+            } else {
+                fprintf(stderr, "Unknown --layout '%s' (expected fifo or counter)\n", l);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+            const char* m = argv[++i];
+            const char* eq = strchr(m, '=');
+            int f = 0;
+            while (eq && f < NUM_FIELDS && std::string(m, eq - m) != FIELD_NAMES[f]) f++;
+            if (!eq || f == NUM_FIELDS) {
+                fprintf(stderr, "Bad --map '%s' (expected FIELD=NAME, FIELD one of rst_n wr_en rd_en data_in enable)\n", m);
+                return 1;
+            }
+            o.names[f] = eq + 1;
+        } else {
+            o.in = argv[i];
+        }
+    }
+    if (!o.in || !o.out) {
+        fprintf(stderr, "usage: stim_convert IN.csv|IN.vcd -o OUT.stim [--layout fifo|counter] [--clock NAME] "
+                        "[--map FIELD=NAME ...]\n       stim_convert --info FILE.stim\n");
+        return 1;
+    }
+
+    FILE* in = fopen(o.in, "r");
+    if (!in) {
+        fprintf(stderr, "stim_convert: cannot read %s\n", o.in);
+        return 1;
+    }
+    size_t len = strlen(o.in);
+    bool vcd = len >= 4 && strcmp(o.in + len - 4, ".vcd") == 0;
+
+    StimWriter out;
+    uint32_t width = 0;
+    bool ok = vcd ? convert_vcd(o, in, out, &width) : convert_csv(o, in, out, &width);
+    fclose(in);
+    uint64_t records = out.records(), resets = out.reset_points();
+    if (!out.close() || !ok) {
+        fprintf(stderr, "stim_convert: could not convert %s to %s\n", o.in, o.out);
+        return 1;
+    }
+    printf("%s: %llu cycles, %llu reset points\n", o.out, (unsigned long long)records, (unsigned long long)resets);
+    return 0;
+}
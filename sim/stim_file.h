@@ -0,0 +1,227 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+// =============================================================================
+// Recorded stimulus - captured input streams replayed cycle for cycle
+//
+// A stimulus file holds one fixed-size record per clock cycle, so a
+// testbench maps it read-only and hands the records straight to the DUT and
+// the reference model: nothing is parsed or copied, and the position of any
+// cycle is a multiplication. File layout (little-endian, 64-byte header):
+//   "RTLSTIM1"  u32 version  u32 layout  u32 data width  u32 reserved
+//   u64 cycle number of the first record
+//   u64 records  u64 index offset (bytes)  u64 index entries  u64 reserved
+//   records, 16 bytes each (the layout of FifoStim)
+//   index: u64 record number of the last cycle of every reset
+// Replay can only start where the design state is known, which is right
+// after a reset, so the index lists those points for seeking. Files are
+// written by stim_convert (from CSV or VCD).
+// =============================================================================
+
+enum StimLayout {
+    STIM_FIFO,      // data = data_in, en[0] = wr_en, en[1] = rd_en
+    STIM_COUNTER,   // en[0] = enable
+    STIM_LAYOUTS
+};
+
+inline const char* stim_layout_name(int layout) {
+    return layout == STIM_FIFO ? "fifo" : layout == STIM_COUNTER ? "counter" : "unknown";
+}
+
+// Inputs applied before one rising edge
+struct StimRecord {
+    uint64_t data;
+    uint8_t en[2];
+    uint8_t rst_n;
+    uint8_t _pad[5];
+};
+static_assert(sizeof(StimRecord) == 16, "stimulus records are 16 bytes");
+
+struct StimHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t layout;
+    uint32_t data_width;
+    uint32_t reserved0;
+    uint64_t first_cycle;
+    uint64_t records;
+    uint64_t index_offset;
+    uint64_t index_entries;
+    uint64_t reserved1;
+};
+static_assert(sizeof(StimHeader) == 64, "stimulus header is 64 bytes");
+
+const uint32_t STIM_VERSION = 1;
+
+// =============================================================================
+// StimWriter - builds a stimulus file one cycle at a time
+// =============================================================================
+class StimWriter {
+private:
+    FILE* file;
+    StimHeader hdr;
+    std::vector<uint64_t> resets;
+    bool in_reset;
+    bool failed;
+
+public:
+    StimWriter() : file(NULL), in_reset(false), failed(false) {}
+    ~StimWriter() { close(); }
+
+    StimWriter(const StimWriter&) = delete;
+    StimWriter& operator=(const StimWriter&) = delete;
+
+    bool open(const char* path, StimLayout layout, uint32_t data_width, uint64_t first_cycle) {
+        file = fopen(path, "wb");
+        if (!file) return false;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, "RTLSTIM1", 8);
+        hdr.version = STIM_VERSION;
+        hdr.layout = layout;
+        hdr.data_width = data_width;
+        hdr.first_cycle = first_cycle;
+        // Rewritten by close() once the counts are known
+        if (fwrite(&hdr, sizeof(hdr), 1, file) != 1) failed = true;
+        return !failed;
+    }
+
+    void add(const StimRecord& r) {
+        if (!file) return;
+        // A reset ends at the last cycle it is held for
+        if (in_reset && r.rst_n) resets.push_back(hdr.records - 1);
+        in_reset = !r.rst_n;
+        if (fwrite(&r, sizeof(r), 1, file) != 1) failed = true;
+        hdr.records++;
+    }
+
+    // For sources that only know the data width once every value has been seen
+    void set_data_width(uint32_t width) { hdr.data_width = width; }
+
+    uint64_t records() const { return hdr.records; }
+    uint64_t reset_points() const { return resets.size() + in_reset; }
+
+    // Append the index and fill in the header; false if anything failed to write
+    bool close() {
+        if (!file) return !failed;
+        if (in_reset) resets.push_back(hdr.records - 1);
+        in_reset = false;
+        hdr.index_offset = sizeof(hdr) + hdr.records * sizeof(StimRecord);
+        hdr.index_entries = resets.size();
+        if (!resets.empty() && fwrite(resets.data(), sizeof(uint64_t), resets.size(), file) != resets.size()) {
+            failed = true;
+        }
+        if (fseek(file, 0, SEEK_SET) != 0 || fwrite(&hdr, sizeof(hdr), 1, file) != 1) failed = true;
+        if (fclose(file) != 0) failed = true;
+        file = NULL;
+        return !failed;
+    }
+};
+
+// =============================================================================
+// StimReplay - a stimulus file mapped read-only
+//
+// Pages are read ahead by the kernel (MADV_SEQUENTIAL) and handed back once
+// replay is past them (release()), so a trace of any size replays in a
+// constant amount of memory.
+// =============================================================================
+class StimReplay {
+private:
+    static const size_t RELEASE_BYTES = 64 << 20;   // drop consumed pages this many at a time
+
+    int fd;
+    uint8_t* base;
+    size_t length;
+    StimHeader hdr;
+    const StimRecord* recs;
+    const uint64_t* index;
+    size_t released;   // bytes from the start already handed back
+
+public:
+    StimReplay() : fd(-1), base(NULL), length(0), recs(NULL), index(NULL), released(0) {
+        memset(&hdr, 0, sizeof(hdr));
+    }
+    ~StimReplay() {
+        if (base) munmap(base, length);
+        if (fd >= 0) ::close(fd);
+    }
+
+    StimReplay(const StimReplay&) = delete;
+    StimReplay& operator=(const StimReplay&) = delete;
+
+    // Map path; false (with the reason in error) if it is not a valid stimulus file
+    bool open(const char* path, const char** error) {
+        *error = NULL;
+        fd = ::open(path, O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            *error = "cannot open";
+            return false;
+        }
+        length = st.st_size;
+        if (length < sizeof(StimHeader)) {
+            *error = "too short for a header";
+            return false;
+        }
+        void* p = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            *error = "mmap failed";
+            return false;
+        }
+        base = (uint8_t*)p;
+        madvise(base, length, MADV_SEQUENTIAL);
+
+        memcpy(&hdr, base, sizeof(hdr));
+        uint64_t max_records = (length - sizeof(hdr)) / sizeof(StimRecord);
+        if (memcmp(hdr.magic, "RTLSTIM1", 8) != 0 || hdr.version != STIM_VERSION) {
+            *error = "not a stimulus file (or a different version)";
+        } else if (hdr.layout >= STIM_LAYOUTS || hdr.data_width > 64) {
+            *error = "unknown layout";
+        } else if (hdr.records > max_records ||
+                   hdr.index_offset != sizeof(hdr) + hdr.records * sizeof(StimRecord) ||
+                   hdr.index_entries > (length - hdr.index_offset) / sizeof(uint64_t)) {
+            *error = "truncated (was stim_convert interrupted?)";
+        }
+        if (*error) return false;
+
+        recs = (const StimRecord*)(base + sizeof(hdr));
+        index = (const uint64_t*)(base + hdr.index_offset);
+        return true;
+    }
+
+    StimLayout layout() const { return (StimLayout)hdr.layout; }
+    uint32_t data_width() const { return hdr.data_width; }
+    uint64_t first_cycle() const { return hdr.first_cycle; }
+    uint64_t size() const { return hdr.records; }
+    const StimRecord* records() const { return recs; }
+    uint64_t reset_points() const { return hdr.index_entries; }
+
+    // Record to start from to reach cycle: the last reset at or before it
+    // (the state is unknown anywhere else), or the first record if none is
+    uint64_t seek(uint64_t cycle) const {
+        uint64_t rec = cycle > hdr.first_cycle ? cycle - hdr.first_cycle : 0;
+        if (rec >= hdr.records) rec = hdr.records ? hdr.records - 1 : 0;
+        const uint64_t* end = index + hdr.index_entries;
+        const uint64_t* after = std::upper_bound(index, end, rec);
+        return after == index ? 0 : *(after - 1);
+    }
+
+    // Replay is done with every record before rec
+    void release(uint64_t rec) {
+        size_t upto = sizeof(hdr) + rec * sizeof(StimRecord);
+        size_t page = sysconf(_SC_PAGESIZE);
+        upto -= upto % page;
+        if (upto < released + RELEASE_BYTES) return;
+        madvise(base + released, upto - released, MADV_DONTNEED);
+        released = upto;
+    }
+};
@@ -1,91 +1,338 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <chrono>
 #include "Vcounter.h"
+#if __has_include("Vcounter___024root.h")
+#include "Vcounter___024root.h" //lets EdgeClock find the model's clk edge state
+#endif
 #include "verilated.h"
+#include "trace.h"
+#include "tb_log.h"
+#include "clocking.h"
+#include "prng.h"
+#include "phase_timer.h"
+#include "stim_file.h"
+#include "counter_model.h" //the reference model (Zig, or the C++ one with MODEL_BACKEND=cpp)
 
-// Zig reference model functions (compiled from counter_model.zig)
-extern "C" {
-    void counter_init();
-    void counter_tick();
-    void counter_set_reset(bool rst_n);
-    void counter_set_enable(bool enable);
-    unsigned char counter_get_count();
+// Hot-path phases, timed when built with -DTB_PHASES (see phase_timer.h)
+const int PH_EVAL = phase_register("eval");
+const int PH_MODEL = phase_register("model");
+const int PH_COMPARE = phase_register("compare");
+const int PH_TRACE = phase_register("trace");
+const int PH_STIMULUS = phase_register("stimulus");
+const int PH_PREDICT = phase_register("predict");
+
+// The counter's only output, for --clocking check
+uint64_t counter_outputs(const Vcounter* dut) {
+    return dut->count;
+}
+
+// Soak mode (--soak N): N cycles of random enable/reset checked against a closed-form
+// prediction instead of the step-by-step Zig model. Stimulus comes 64 cycles to a word
+// (bit i = cycle i), and after each word the count has to be
+//   no reset in the word:  (count before + popcount(enable bits)) mod 256
+//   otherwise:             popcount(enable bits after the last reset cycle) mod 256
+// so the prediction costs a few instructions per 64 cycles and the run measures the
+// simulation path itself. The DUT is compared every --check-every words.
+const int SOAK_BLOCK_WORDS = 64;  //words of stimulus generated at a time (4096 cycles)
+const int SOAK_RESET_AND = 12;    //reset bits are the AND of 12 random words: one cycle in 4096
+const int SOAK_MAX_REPORTS = 10;  //mismatches printed before the rest are only counted
+
+struct SoakResult {
+    uint64_t cycles;  //simulated (N rounded up to whole words)
+    uint64_t checks;  //DUT comparisons made
+    uint64_t resets;  //cycles with reset asserted
+    uint64_t wraps;   //times the count went from 255 back to 0
+    int errors;
+};
+
+SoakResult run_soak(Vcounter* dut, EdgeClock<Vcounter>& clock, uint64_t cycles, uint64_t seed,
+                    int check_every, bool debug) {
+    SoakResult r = {0, 0, 0, 0, 0};
+    Xoshiro256x4 rng(seed);
+    uint64_t rnd[SOAK_BLOCK_WORDS * (1 + SOAK_RESET_AND)];
+    uint64_t words = (cycles + 63) / 64;
+    unsigned predicted = dut->count; //0 straight after the reset sequence
+
+    for (uint64_t w = 0; w < words; w++) {
+        int k = w % SOAK_BLOCK_WORDS;
+        if (k == 0) { //next block of stimulus
+            TB_PHASE(PH_STIMULUS);
+            rng.fill(rnd, sizeof(rnd) / sizeof(rnd[0]));
+        }
+
+        uint64_t en = rnd[k];
+        uint64_t rst = ~0ull;
+        for (int j = 1; j <= SOAK_RESET_AND; j++) rst &= rnd[j * SOAK_BLOCK_WORDS + k];
+
+        { //drive the word one cycle at a time, timed as one eval phase per word
+            TB_PHASE(PH_EVAL);
+            for (int b = 0; b < 64; b++) {
+                dut->rst_n = !((rst >> b) & 1);
+                dut->enable = (en >> b) & 1;
+                if (!clock.tick()) {
+                    printf("ERROR at cycle %llu: falling edge changed the RTL, edge elision is not safe\n",
+                           (unsigned long long)(r.cycles + b));
+                    r.errors++;
+                }
+            }
+        }
+        r.cycles += 64;
+
+        // Closed-form count after the word
+        {
+            TB_PHASE(PH_PREDICT);
+            if (rst == 0) {
+                unsigned sum = predicted + __builtin_popcountll(en);
+                r.wraps += sum >> 8;
+                predicted = sum & 0xff;
+            } else {
+                int first = __builtin_ctzll(rst);
+                int last = 63 - __builtin_clzll(rst);
+                uint64_t before_first = en & ((1ull << first) - 1);
+                uint64_t after_last = last == 63 ? 0 : en & (~0ull << (last + 1));
+                r.wraps += (predicted + __builtin_popcountll(before_first)) >> 8; //later segments are under 64 cycles
+                r.resets += __builtin_popcountll(rst);
+                predicted = __builtin_popcountll(after_last);
+            }
+        }
+
+        if ((w + 1) % check_every != 0 && w + 1 != words) continue; //only check at batch ends
+        TB_PHASE(PH_COMPARE);
+        r.checks++;
+        if (dut->count != predicted) {
+            if (r.errors < SOAK_MAX_REPORTS) {
+                printf("ERROR after cycle %llu: RTL=%d, Predicted=%d (MISMATCH)\n",
+                       (unsigned long long)r.cycles, dut->count, predicted);
+            }
+            r.errors++;
+            predicted = dut->count; //resync so one bad edge is not reported at every later check
+        } else if (debug) {
+            printf("Cycle %llu: RTL=%3d, Predicted=%3d (match)\n", (unsigned long long)r.cycles,
+                   dut->count, predicted);
+        }
+    }
+    return r;
 }
 
 int main(int argc, char** argv) {
     // Initialize Verilator
     Verilated::commandArgs(argc, argv);
 
+    // Optional binary cycle trace: --trace FILE records every cycle, adding
+    // --flight N only keeps the last N cycles and writes them on the first mismatch.
+    // --log-level error|info|debug picks how chatty we are (per-cycle lines are debug),
+    // --summary FILE writes the results as JSON (or CSV if FILE ends in .csv),
+    // --clocking elide|two-edge|check picks how clock edges are evaluated (see clocking.h),
+    // --soak N runs N random cycles against the closed-form prediction instead of the 20
+    // step-by-step ones (--seed S, --check-every W compares the DUT every W*64 cycles),
+    // --phases FILE writes the per-phase time breakdown as JSON and --phase-counters adds
+    // hardware counters to it (both need -DTB_PHASES, see phase_timer.h),
+    // --replay FILE drives recorded enable/reset (stim_convert --layout counter) instead,
+    // starting at the last reset before --replay-from CYCLE, for --replay-cycles N (0 = all)
+    const char* trace_path = NULL;
+    const char* summary_path = NULL;
+    int flight_cycles = 0;
+    int log_level = TB_LOG_INFO;
+    int clock_mode = CLOCK_ELIDE;
+    const char* phases_path = NULL;
+    bool phase_counters = false;
+    uint64_t soak_cycles = 0;
+    uint64_t seed = 1;
+    int check_every = 1;
+    const char* replay_path = NULL;
+    uint64_t replay_from = 0;
+    uint64_t replay_cycles = 0;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0) trace_path = argv[i + 1];
+        if (strcmp(argv[i], "--flight") == 0) flight_cycles = atoi(argv[i + 1]);
+        if (strcmp(argv[i], "--summary") == 0) summary_path = argv[i + 1];
+        if (strcmp(argv[i], "--log-level") == 0) log_level = parse_log_level(argv[i + 1]);
+        if (strcmp(argv[i], "--clocking") == 0) clock_mode = parse_clock_mode(argv[i + 1]);
+        if (strcmp(argv[i], "--soak") == 0) soak_cycles = strtoull(argv[i + 1], NULL, 0);
+        if (strcmp(argv[i], "--seed") == 0) seed = strtoull(argv[i + 1], NULL, 0);
+        if (strcmp(argv[i], "--check-every") == 0) check_every = atoi(argv[i + 1]);
+        if (strcmp(argv[i], "--phases") == 0) phases_path = argv[i + 1];
+        if (strcmp(argv[i], "--replay") == 0) replay_path = argv[i + 1];
+        if (strcmp(argv[i], "--replay-from") == 0) replay_from = strtoull(argv[i + 1], NULL, 0);
+        if (strcmp(argv[i], "--replay-cycles") == 0) replay_cycles = strtoull(argv[i + 1], NULL, 0);
+    }
+    for (int i = 1; i < argc; i++) { //flags without a value
+        if (strcmp(argv[i], "--phase-counters") == 0) phase_counters = true;
+    }
+#ifndef TB_PHASES
+    if (phases_path || phase_counters) {
+        fprintf(stderr, "--phases/--phase-counters need a build with -DTB_PHASES (make ... PHASES=1)\n");
+        return 1;
+    }
+#endif
+    if (phase_counters) phase_enable_counters(); //before the first timed phase opens the counters
+    if (log_level < 0) {
+        fprintf(stderr, "Unknown --log-level (expected error, info or debug)\n");
+        return 1;
+    }
+    if (clock_mode < 0) {
+        fprintf(stderr, "Unknown --clocking (expected elide, two-edge or check)\n");
+        return 1;
+    }
+    if (soak_cycles && trace_path) { //a per-cycle trace would need the per-cycle model soak mode avoids
+        fprintf(stderr, "--trace is not supported with --soak\n");
+        return 1;
+    }
+    if (check_every < 1) check_every = 1;
+
+    StimReplay replay; //recorded stimulus, mapped rather than read
+    uint64_t replay_start = 0, replay_end = 0; //records to run
+    if (replay_path) {
+        const char* error = NULL;
+        if (soak_cycles) {
+            error = "--soak generates its own stimulus";
+        } else if (replay.open(replay_path, &error) && replay.layout() != STIM_COUNTER) {
+            error = "recorded for the FIFO, not the counter";
+        }
+        if (error) {
+            fprintf(stderr, "Cannot replay %s: %s\n", replay_path, error);
+            return 1;
+        }
+        uint64_t from = replay_from > replay.first_cycle() ? replay_from - replay.first_cycle() : 0;
+        replay_start = replay.seek(replay_from); //the state is only known right after a reset
+        replay_end = replay.size();
+        if (replay_cycles && from + replay_cycles < replay_end) replay_end = from + replay_cycles;
+        if (replay_end < replay_start) replay_end = replay_start;
+    }
+    bool info = TB_LOG_MAX >= TB_LOG_INFO && log_level >= TB_LOG_INFO; //banners and progress
+    bool debug = TB_LOG_MAX >= TB_LOG_DEBUG && log_level >= TB_LOG_DEBUG; //every cycle
+    TraceWriter* trace = NULL;
+    if (trace_path) {
+        trace = new TraceWriter(trace_path, {{"rst_n", 1}, {"enable", 1}, {"count", 8}, {"ref_count", 8}},
+                                flight_cycles > 0 ? flight_cycles : 0);
+    }
+
     // Create instance of our RTL counter
     Vcounter* dut = new Vcounter;
+    EdgeClock<Vcounter> clock(dut, (ClockMode)clock_mode, counter_outputs); //evaluates only the rising edge (unless two-edge/check)
 
-    // Initialize Zig reference model
+    // Initialize the reference model (Zig, or CounterRef with TB_MODEL_CPP)
     counter_init(); //resets the Zig reference model to its starting state with count = 0, reset active, enable off
 
     // Initialize RTL signals
     dut->clk = 0;   //this sets clock to 0
     dut->rst_n = 0; //this sets reset to 0, turning it on/activating it becasue reset is active low
     dut->enable = 0; //this sets enable to 0, disabling counting (from the main loop)
-    dut->eval(); //this tells Verilator to propagate these values throughout the circuit
+    clock.settle(); //this tells Verilator to propagate these values throughout the circuit
 
     // Sync reference model
     counter_set_reset(false); //this sets the Zig model's signals to match the same as the RTL, with both now having reset active
     counter_set_enable(false); //and enable off
 
-    printf("Starting counter verification with Zig reference model...\n");
-    printf("Comparing RTL output against Zig golden model\n\n");
+    if (info) {
+        printf("Starting counter verification with %s reference model...\n", COUNTER_MODEL_NAME);
+        printf("Comparing RTL output against %s golden model\n\n", COUNTER_MODEL_NAME);
+    }
 
     // Reset sequence
     for (int i = 0; i < 4; i++) { //for loop with 4 iterations
-        dut->clk = 1; //rising edge of the clock 
-        dut->eval(); //the rtl will react to the rising edge
+        clock.tick(); //the rtl reacts to the rising edge; the falling edge does nothing because the counter only triggers on rising
         counter_tick();  // Zig model also sees rising edge
-
-        dut->clk = 0; //falling edge of the clock
-        dut->eval(); //RTL will see the falling edge as well but nothing happens because the counter only triggers on rising 
     }
 
     // Release reset on both RTL and reference model
     dut->rst_n = 1; //here is where we change the inputs, reset = 1, in other words -- release reset (1)
     dut->enable = 1; //here is where we change the inputs, enable = 1, in other words -- start counting
-    dut->eval();
+    clock.settle();
 
     counter_set_reset(true); //done for this zig model too, changing the inputs so that they stay in sync
     counter_set_enable(true); //this is like, "I am gonna tell the software model what exactly my inputs are"
 
     // Run test
     int errors = 0; //this initializes the testing variables, errors is a counter that starts at 0
-    int cycles = 20; //also intializies the testing variables, says cycles can only go for 20 iterations
+    uint64_t cycles = soak_cycles ? soak_cycles : 20; //20 step-by-step cycles unless soaking
+    if (replay_path) cycles = replay_end - replay_start; //or as many as are being replayed
+    SoakResult soak = {0, 0, 0, 0, 0};
+    auto start = std::chrono::steady_clock::now(); //for the throughput report
+
+    if (soak_cycles) {
+        if (info) {
+            printf("Soak: %llu cycles of random enable/reset (seed %llu), checked every %d cycles\n",
+                   (unsigned long long)soak_cycles, (unsigned long long)seed, check_every * 64);
+        }
+        soak = run_soak(dut, clock, soak_cycles, seed, check_every, debug);
+        errors = soak.errors;
+        cycles = soak.cycles;
+    }
+    if (replay_path && info) {
+        printf("Replay: %s, %llu cycles from file cycle %llu\n", replay_path, (unsigned long long)cycles,
+               (unsigned long long)(replay.first_cycle() + replay_start));
+    }
+    const StimRecord* recs = replay.records() + replay_start; //only read when replaying
 
-    for (int cycle = 0; cycle < cycles; cycle++) { //cycle for loop, 20 iterations
-        // Rising edge - RTL
-        dut->clk = 1; //same idea/for loop as above
-        dut->eval();
+    for (uint64_t cycle = 0; !soak_cycles && cycle < cycles; cycle++) { //one iteration per step-by-step or replayed cycle; skipped when soaking (run_soak did those)
+        if (replay_path) { //recorded inputs for this cycle, straight from the mapped file
+            dut->rst_n = recs[cycle].rst_n;
+            dut->enable = recs[cycle].en[0];
+            counter_set_reset(recs[cycle].rst_n);
+            counter_set_enable(recs[cycle].en[0]);
+            if ((cycle & 0xffff) == 0) replay.release(replay_start + cycle); //hand back pages already replayed
+        }
 
-        // Rising edge - Zig reference model
-        counter_tick(); //same idea/for loop as above
+        // Rising edge (and falling edge unless elided) - RTL
+        bool clock_ok;
+        {
+            TB_PHASE(PH_EVAL); //phase timer (compiled out unless -DTB_PHASES)
+            clock_ok = clock.tick();
+        }
+        if (!clock_ok) { //check mode: the falling edge changed something, so eliding it would be wrong
+            printf("ERROR at cycle %llu: falling edge changed the RTL, edge elision is not safe\n",
+                   (unsigned long long)cycle);
+            errors++;
+        }
 
-        // Falling edge - RTL
-        dut->clk = 0; //same idea/for loop as above
-        dut->eval();
+        // Rising edge - reference model
+        unsigned char ref_count;
+        {
+            TB_PHASE(PH_MODEL);
+            counter_tick(); //same idea/for loop as above
+            ref_count = counter_get_count(); //gets count value from Zig
+        }
 
         // Compare RTL vs reference model -- Reads the outputs
         unsigned char rtl_count = dut->count; //gets count value from RTL
-        unsigned char ref_count = counter_get_count(); //gets count value from Zig
+
+        if (trace) { //record this cycle's inputs and both outputs in the trace
+            TB_PHASE(PH_TRACE);
+            uint64_t values[4] = {dut->rst_n, dut->enable, rtl_count, ref_count};
+            trace->sample(cycle, values);
+        }
+
+        TB_PHASE(PH_COMPARE);
 
         if (rtl_count != ref_count) { //if both RTL and Zig are different values, print Error and increment the error count
-            printf("ERROR at cycle %d: RTL=%d, Reference=%d (MISMATCH)\n",
-                   cycle, rtl_count, ref_count);
+            printf("ERROR at cycle %llu: RTL=%d, Reference=%d (MISMATCH)\n",
+                   (unsigned long long)cycle, rtl_count, ref_count);
             errors++;
-        } else { //if they are the same value, print that they match
-            printf("Cycle %2d: RTL=%2d, Reference=%2d (match)\n",
-                   cycle, rtl_count, ref_count);
+            if (trace && trace->trigger()) { //flight recorder: dump the cycles leading up to the first mismatch
+                printf("Last %llu cycles written to %s\n",
+                       (unsigned long long)trace->flight_size(), trace->get_path());
+            }
+        } else if (debug) { //if they are the same value, print that they match (debug level only)
+            printf("Cycle %2llu: RTL=%2d, Reference=%2d (match)\n",
+                   (unsigned long long)cycle, rtl_count, ref_count);
         }
     }
 
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
     // Report results
-    printf("\n========== Test Complete ==========\n"); //prints whether test passed or failed 
-    printf("Cycles tested: %d\n", cycles);
+    if (info) {
+        printf("\n========== Test Complete ==========\n"); //prints whether test passed or failed 
+        printf("Cycles tested: %llu\n", (unsigned long long)cycles);
+        if (soak_cycles) {
+            printf("Checks: %llu, resets: %llu, wrap-arounds: %llu\n", (unsigned long long)soak.checks,
+                   (unsigned long long)soak.resets, (unsigned long long)soak.wraps);
+            printf("Throughput: %.0f cycles/s (%.2f s)\n", cycles / seconds, seconds);
+        }
+    }
     if (errors == 0) { //if there aren't any errors print passed
         printf("Result: PASSED - RTL matches reference model\n");
     } else { //if there are any errors print failed
@@ -93,7 +340,30 @@ int main(int argc, char** argv) {
     }
 
 
+    if (summary_path) { //machine-readable copy of the result for dashboards
+        RunSummary summary;
+        summary.add("testbench", "tb_counter");
+        summary.add("mode", soak_cycles ? "soak" : replay_path ? "replay" : "step");
+        summary.add("cycles", cycles);
+        summary.add("checks", soak_cycles ? soak.checks : cycles);
+        summary.add("wraps", soak.wraps);
+        summary.add("seconds", seconds);
+        summary.add("mismatches", errors);
+        summary.add("clocking", clock_mode_name((ClockMode)clock_mode));
+        summary.add("passed", errors == 0);
+        if (!summary.write(summary_path)) fprintf(stderr, "Could not write summary %s\n", summary_path);
+    }
+
+#ifdef TB_PHASES
+    PhaseReport phases = phase_report(); //where the time went
+    if (info) phase_print(phases);
+    if (phases_path && !phase_write_json(phases, phases_path, "tb_counter")) {
+        fprintf(stderr, "Could not write phase breakdown %s\n", phases_path);
+    }
+#endif
+
     //cleanup area/exit
+    delete trace; //flushes and closes the trace file
     delete dut; //free memory
     return errors > 0 ? 1 : 0; //return 1 if there were errors, 0 if no errors 
 }
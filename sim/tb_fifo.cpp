@@ -1,538 +1,2702 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
 #include <time.h>
-#include <queue>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
 #include "Vfifo.h"
+#if __has_include("Vfifo___024root.h")
+#include "Vfifo___024root.h"   // lets EdgeClock find the model's clk edge state
+#endif
 #include "verilated.h"
-
-// Zig reference model functions
-extern "C" {
-    void fifo_init();
-    void fifo_tick();
-    void fifo_set_reset(bool rst_n);
-    void fifo_set_wr_en(bool wr_en);
-    void fifo_set_rd_en(bool rd_en);
-    void fifo_set_data_in(unsigned char data);
-    unsigned char fifo_get_data_out();
-    bool fifo_get_full();
-    bool fifo_get_empty();
-    size_t fifo_get_count();
-}
+#include "fifo_model.h"
+#include "scoreboard.h"
+#include "fifo_monitor.h"
+#include "latency_checker.h"
+#include "coverage.h"
+#include "prng.h"
+#include "trace.h"
+#include "tb_log.h"
+#include "clocking.h"
+#include "fifo_bank.h"
+#include "fork_pool.h"
+#include "phase_timer.h"
+#include "stim_file.h"
+#include "result_file.h"
+#include "fault_inject.h"
+#ifdef TB_CHECKPOINT
+#include "checkpoint.h"   // needs a --savable model (the Makefile's default)
+#endif
+
+// Worst-case write-to-read latency the tests tolerate (20 cycles at depth 8)
+const int MAX_LATENCY = 2 * FIFO_DEPTH + 4;
+
+// Hot-path phases, timed when built with -DTB_PHASES (see phase_timer.h).
+// The last three are whole tests, so they include the others.
+const int PH_EVAL = phase_register("eval");
+const int PH_MODEL = phase_register("model");
+const int PH_COMPARE = phase_register("compare");
+const int PH_MONITOR = phase_register("monitor");
+const int PH_COVERAGE = phase_register("coverage");
+const int PH_LATENCY = phase_register("latency");
+const int PH_STIMULUS = phase_register("stimulus");
+const int PH_TRACE = phase_register("trace");
+const int PH_LOG = phase_register("log");
+const int PH_STRESS = phase_register("stress");
+const int PH_BURSTS = phase_register("bursts");
+const int PH_LANES = phase_register("lanes");
+const int PH_REPLAY = phase_register("replay");
 
 // =============================================================================
-// Latency Checker - Tracks write-to-read latency for data through the FIFO
+// Functional Coverage Tracker - the FIFO covergroup
 // =============================================================================
-class LatencyChecker {
-private:
-    struct Transaction {
-        unsigned char data;
-        int write_cycle;
+class CoverageTracker {
+public:
+    enum { STATE_PARTIAL, STATE_EMPTY, STATE_FULL };
+    enum { OP_IDLE, OP_WRITE, OP_READ, OP_WRITE_READ };   // wr_en | rd_en << 1
+
+    // Something the stimulus can do to hit an open bin: bring the FIFO to
+    // `count` entries, then request `op` on the next `repeat` edges
+    struct Goal {
+        int count;
+        int op;
+        int repeat;
     };
-    std::queue<Transaction> pending;
-    int total_transactions;
-    int total_latency;
-    int min_latency;
-    int max_latency;
-    int latency_violations;
-    int max_allowed_latency;
+
+private:
+    CoverGroup cg;
+    int cp_state;      // empty/partial/full after the edge
+    int cp_op;         // wr_en/rd_en requested on the edge
+    int cp_count;
+    int cp_rollover;
+    int cx_state_op;
+    std::vector<CoverBin> count_bins;
+
+    mutable uint64_t cached_version;
+    mutable double cached_percent;
+
+    bool state_op_hit(int state, int op) const {
+        return cg.is_hit(cx_state_op, cg.cross_bin(cx_state_op, state, op));
+    }
+
+    int scenario_hits() const {
+        return seen_empty() + seen_full() + seen_write_when_full() + seen_read_when_empty() +
+               seen_simultaneous_rw() + seen_rollover();
+    }
 
 public:
-    LatencyChecker(int max_latency_cycles) :
-        total_transactions(0),
-        total_latency(0),
-        min_latency(999999),
-        max_latency(0),
-        latency_violations(0),
-        max_allowed_latency(max_latency_cycles) {}
+    CoverageTracker() : cg("fifo"), cached_version(UINT64_MAX), cached_percent(0) {
+        count_bins = cover_bins_auto(FIFO_DEPTH, 64);
+        cp_state = cg.coverpoint("state", 3, {{"partial", 0, 0}, {"empty", 1, 1}, {"full", 2, 2}});
+        cp_op = cg.coverpoint("op", 4, {{"idle", 0, 0}, {"write", 1, 1}, {"read", 2, 2},
+                                        {"write_read", 3, 3}});
+        cp_count = cg.coverpoint("count", FIFO_DEPTH + 1, count_bins);
+        cp_rollover = cg.coverpoint("rollover", 2, {{"hit", 1, 1}});
+        // A write into an empty FIFO always lands and a read from a full one
+        // always frees a slot, so these pairings can never be observed
+        cx_state_op = cg.cross("state_x_op", cp_state, cp_op,
+                               {{STATE_EMPTY, OP_WRITE}, {STATE_EMPTY, OP_WRITE_READ},
+                                {STATE_FULL, OP_READ}, {STATE_FULL, OP_WRITE_READ}});
+    }
 
-    void record_write(unsigned char data, int cycle) {
-        Transaction t = {data, cycle};
-        pending.push(t);
+    void sample(bool empty, bool full, int count, bool wr_en, bool rd_en) {
+        TB_PHASE(PH_COVERAGE);
+        uint32_t values[4] = {
+            (uint32_t)empty | ((uint32_t)full << 1),   // empty and full together is ignored
+            (uint32_t)wr_en | ((uint32_t)rd_en << 1),
+            (uint32_t)count,
+            COVER_NO_SAMPLE,
+        };
+        cg.sample(values);
     }
 
-    bool check_read(unsigned char data, int cycle) {
-        if (pending.empty()) {
-            printf("  [LATENCY ERROR] Read with no pending write!\n");
-            return false;
-        }
+    void record_rollover() { cg.sample_point(cp_rollover, 1); }
 
-        Transaction t = pending.front();
-        pending.pop();
+    bool seen_empty() const { return cg.is_hit(cp_state, STATE_EMPTY); }
+    bool seen_full() const { return cg.is_hit(cp_state, STATE_FULL); }
+    bool seen_write_when_full() const { return state_op_hit(STATE_FULL, OP_WRITE); }
+    bool seen_read_when_empty() const { return state_op_hit(STATE_EMPTY, OP_READ); }
+    bool seen_simultaneous_rw() const { return cg.is_hit(cp_op, OP_WRITE_READ); }
+    bool seen_rollover() const { return cg.is_hit(cp_rollover, 0); }
 
-        if (t.data != data) {
-            printf("  [LATENCY ERROR] Data mismatch: expected %d, got %d\n", t.data, data);
-            return false;
+    // One goal per bin still open: count bins are reached and held for an
+    // edge, state x op bins need the count for that state and then the op,
+    // and rollover needs a full lap of the read pointer
+    void open_goals(std::vector<Goal>& goals) const {
+        static const int state_count[3] = {FIFO_DEPTH / 2, 0, FIFO_DEPTH};
+
+        for (uint32_t b = 0; b < count_bins.size(); b++) {
+            if (!cg.is_hit(cp_count, b)) goals.push_back(Goal{(int)count_bins[b].lo, OP_IDLE, 1});
+        }
+        for (int s = 0; s < 3; s++) {
+            for (int op = 0; op < 4; op++) {
+                uint32_t b = cg.cross_bin(cx_state_op, s, op);
+                if (b != UINT32_MAX && !cg.is_hit(cx_state_op, b)) {
+                    goals.push_back(Goal{state_count[s], op, 2});
+                }
+            }
         }
+        if (!seen_rollover()) goals.push_back(Goal{FIFO_DEPTH / 2, OP_WRITE_READ, FIFO_DEPTH + 1});
+    }
 
-        int latency = cycle - t.write_cycle;
-        total_transactions++;
-        total_latency += latency;
+    // Union of hit bins, sum of counters
+    void merge(const CoverageTracker& other) { cg.merge(other.cg); }
 
-        if (latency < min_latency) min_latency = latency;
-        if (latency > max_latency) max_latency = latency;
+    // Checkpointing (see CoverGroup::save_state)
+    void save_state(std::vector<uint64_t>& out) { cg.save_state(out); }
+    bool restore_state(const std::vector<uint64_t>& in) { return cg.restore_state(in); }
 
-        if (latency > max_allowed_latency) {
-            printf("  [LATENCY VIOLATION] Data %d took %d cycles (max: %d)\n",
-                   data, latency, max_allowed_latency);
-            latency_violations++;
-            return false;
-        }
+    bool save(const char* path) { return cg.save(path); }
 
-        return true;
-    }
+    const CoverGroup& group() const { return cg; }
 
     void print_report() {
-        printf("\n========== Latency Report ==========\n");
-        printf("Total transactions: %d\n", total_transactions);
-        if (total_transactions > 0) {
-            printf("Min latency: %d cycles\n", min_latency);
-            printf("Max latency: %d cycles\n", max_latency);
-            printf("Avg latency: %.2f cycles\n", (float)total_latency / total_transactions);
+        printf("\n========== Coverage Report ==========\n");
+        printf("Empty state:           %s\n", seen_empty() ? "HIT" : "MISS");
+        printf("Full state:            %s\n", seen_full() ? "HIT" : "MISS");
+        printf("Write when full:       %s\n", seen_write_when_full() ? "HIT" : "MISS");
+        printf("Read when empty:       %s\n", seen_read_when_empty() ? "HIT" : "MISS");
+        printf("Simultaneous R/W:      %s\n", seen_simultaneous_rw() ? "HIT" : "MISS");
+        printf("Pointer rollover:      %s\n", seen_rollover() ? "HIT" : "MISS");
+        printf("\nCount distribution:\n");
+        for (uint32_t b = 0; b < cg.num_bins(cp_count); b++) {
+            // Deep FIFOs only list the counts that were actually seen
+            if (FIFO_DEPTH > 16 && !cg.is_hit(cp_count, b)) continue;
+            printf("  count=%s: %llu samples\n", cg.bin_name(cp_count, b),
+                   (unsigned long long)cg.bin_count(cp_count, b));
         }
-        printf("Latency violations: %d\n", latency_violations);
-        printf("Max allowed latency: %d cycles\n", max_allowed_latency);
+
+        int hits = scenario_hits();
+        printf("\nCoverage: %d/6 bins hit (%.1f%%)\n", hits, hits * 100.0 / 6);
+        cg.print_report();
     }
 
-    int get_violations() { return latency_violations; }
+    // Whole covergroup: every coverpoint and cross weighted equally. Cheap
+    // enough to poll every cycle: only recomputed after a new bin is hit.
+    double get_coverage_percent() const {
+        if (cg.hit_version() != cached_version) {
+            cached_version = cg.hit_version();
+            cached_percent = cg.coverage();
+        }
+        return cached_percent;
+    }
 };
 
 // =============================================================================
-// Functional Coverage Tracker
+// Stimulus for the randomized test
+//
+// STIM_RANDOM is the original coin flip on wr_en/rd_en, never writing when
+// full or reading when empty. STIM_DIRECTED looks at which bins of the
+// seed's covergroup are still open, picks one at random, drives the count to
+// where that bin can be hit and then issues the operation it needs (writes
+// when full and reads when empty included). Once every bin is hit it falls
+// back to random bursts.
+//
+// Both keep to the latency contract: the generator follows which edge each
+// queued entry was written on and reads whenever the oldest would otherwise
+// wait longer than MAX_LATENCY, so holds (idle, or writing while full) end in
+// time however long the run.
 // =============================================================================
-class CoverageTracker {
+enum StimStrategy { STIM_RANDOM, STIM_DIRECTED };
+
+class StimulusGenerator {
 private:
-    bool seen_empty;
-    bool seen_full;
-    bool seen_write_when_full;
-    bool seen_read_when_empty;
-    bool seen_simultaneous_rw;
-    bool seen_rollover;
-    int  count_bins[9];  // 0-8 for depth=8
+    StimStrategy strategy;
+    const CoverageTracker& coverage;
+    Xoshiro256& rng;
+
+    std::vector<CoverageTracker::Goal> goals;
+    CoverageTracker::Goal goal;
+    int drive_left;    // edges left to reach goal.count before giving up
+    int repeat_left;   // edges of goal.op still to issue
+
+    // Edges issued, and a ring of the edges the queued entries were written
+    // on, oldest at head
+    uint64_t edge;
+    std::vector<uint64_t> written;
+    int head;
+    int queued;
+
+    void plan() {
+        goals.clear();
+        coverage.open_goals(goals);
+        if (goals.empty()) {
+            goal.count = rng() % (FIFO_DEPTH + 1);
+            goal.op = rng() % 4;
+            goal.repeat = 1 + rng() % FIFO_DEPTH;
+        } else {
+            goal = goals[rng() % goals.size()];
+        }
+        drive_left = FIFO_DEPTH + 1;
+        repeat_left = goal.repeat;
+    }
+
+    // Enables the strategy asks for
+    void choose(int count, uint64_t coins, bool* wr_en, bool* rd_en) {
+        if (strategy == STIM_RANDOM) {
+            *wr_en = (coins & 1) && count < FIFO_DEPTH;
+            *rd_en = (coins & 2) && count > 0;
+            return;
+        }
+
+        if (repeat_left == 0) plan();
+        if (count != goal.count && drive_left > 0) {
+            drive_left--;
+            *wr_en = count < goal.count;
+            *rd_en = count > goal.count;
+            return;
+        }
+        drive_left = 0;
+        repeat_left--;
+        *wr_en = goal.op & 1;
+        *rd_en = (goal.op >> 1) & 1;
+    }
+
+    // Line the ring up with the FIFO's count, which moves without the
+    // generator when other tests ran in between: entries it did not see
+    // written are taken to be due for reading now
+    void sync(int count) {
+        for (; queued > count; queued--) head = (head + 1) % FIFO_DEPTH;
+        for (; queued < count; queued++) {
+            head = (head + FIFO_DEPTH - 1) % FIFO_DEPTH;
+            written[head] = edge - MAX_LATENCY;
+        }
+    }
 
 public:
-    CoverageTracker() :
-        seen_empty(false), seen_full(false),
-        seen_write_when_full(false), seen_read_when_empty(false),
-        seen_simultaneous_rw(false), seen_rollover(false) {
-        for (int i = 0; i < 9; i++) count_bins[i] = 0;
+    StimulusGenerator(StimStrategy s, const CoverageTracker& cov, Xoshiro256& r) :
+        strategy(s), coverage(cov), rng(r), drive_left(0), repeat_left(0),
+        edge(0), written(FIFO_DEPTH), head(0), queued(0) {}
+
+    // Enables for the next edge, given the FIFO count before it and two
+    // random bits from the pre-generated stimulus block
+    void next(int count, uint64_t coins, bool* wr_en, bool* rd_en) {
+        TB_PHASE(PH_STIMULUS);
+        choose(count, coins, wr_en, rd_en);
+
+        // Reading the oldest entry on this edge is what keeps it within the
+        // bound; those behind it were written later, so they stay within it
+        // too while the reads go on
+        sync(count);
+        if (queued > 0 && edge - written[head] >= (uint64_t)MAX_LATENCY) *rd_en = true;
+        bool wrote = *wr_en && count < FIFO_DEPTH;
+        if (*rd_en && queued > 0) {
+            head = (head + 1) % FIFO_DEPTH;
+            queued--;
+        }
+        if (wrote) written[(head + queued++) % FIFO_DEPTH] = edge;
+        edge++;
     }
 
-    void sample(bool empty, bool full, int count, bool wr_en, bool rd_en) {
-        if (empty) seen_empty = true;
-        if (full) seen_full = true;
-        if (wr_en && full) seen_write_when_full = true;
-        if (rd_en && empty) seen_read_when_empty = true;
-        if (wr_en && rd_en) seen_simultaneous_rw = true;
-        if (count >= 0 && count <= 8) count_bins[count]++;
+    // Checkpointing: the goal being worked on and the progress towards it,
+    // then the edge count and the write edges of the queued entries
+    void save_state(std::vector<uint64_t>& out) const {
+        out.assign({(uint64_t)goal.count, (uint64_t)goal.op, (uint64_t)goal.repeat,
+                    (uint64_t)drive_left, (uint64_t)repeat_left, edge, (uint64_t)queued});
+        for (int i = 0; i < queued; i++) out.push_back(written[(head + i) % FIFO_DEPTH]);
+    }
+    bool restore_state(const std::vector<uint64_t>& in) {
+        if (in.size() < 7 || in[6] > FIFO_DEPTH || in.size() != 7 + in[6]) return false;
+        goal.count = (int)in[0];
+        goal.op = (int)in[1];
+        goal.repeat = (int)in[2];
+        drive_left = (int)in[3];
+        repeat_left = (int)in[4];
+        edge = in[5];
+        head = 0;
+        queued = (int)in[6];
+        std::copy(in.begin() + 7, in.end(), written.begin());
+        return true;
     }
+};
 
-    void record_rollover() { seen_rollover = true; }
+// =============================================================================
+// Command-line options
+// =============================================================================
+struct TbOptions {
+    uint64_t base_seed;  // --seed N (default: time based, printed for reruns)
+    int num_seeds;       // --seeds N: run N seeds starting at base_seed
+                         // (--seed-range A:B runs seeds A..B inclusive)
+    int num_jobs;        // --jobs N: worker threads (0 = one per core)
+    int num_lanes;       // --lanes K: seeds each worker steps together (regressions only)
+    bool fork;           // --fork: reset once, then each directed test and each seed in
+                         // its own child process (--jobs at a time)
+    int random_cycles;   // --cycles N: cycle budget of the randomized stress test
+    int burst_cycles;    // --burst-cycles N: cycle budget of the burst stress test (0 = skip)
+    bool burst_per_cycle;    // --burst-check boundary|cycle: check bursts only where they
+                             // end (the default), or every cycle; --trace implies cycle
+    const char* cov_out; // --cov-out FILE: write the (merged) coverage database
+    const char* trace_path;  // --trace FILE: binary cycle trace (FILE.<seed> per seed
+                             // in a regression); read it back with trace_dump
+    int flight_cycles;   // --flight N: only keep the last N cycles of the trace and
+                         // write them on the first mismatch
+    int log_level;       // --log-level error|info|debug (see tb_log.h)
+    const char* summary_path;    // --summary FILE: JSON (or .csv) results at exit
+    const char* result_path;     // --result FILE: binary result record for the
+                                 // regression dispatcher (see result_file.h)
+    const char* checkpoint_path; // --checkpoint FILE: snapshot the stress test while the seed
+                                 // passes (FILE.<seed> per seed in a regression, kept only
+                                 // for failing seeds; not with --lanes)
+    int checkpoint_every;        // --checkpoint-every N: cycles between snapshots
+    const char* restore_path;    // --restore FILE: resume from a snapshot, traced
+    const char* phases_path;     // --phases FILE: per-phase time breakdown as JSON
+                                 // (needs -DTB_PHASES, which also prints it at exit)
+    bool phase_counters;         // --phase-counters: hardware counters per phase too
+    const char* replay_path;     // --replay FILE: run recorded stimulus (stim_convert)
+                                 // instead of the generated tests
+    uint64_t replay_from;        // --replay-from CYCLE: start at the last reset before it
+    uint64_t replay_cycles;      // --replay-cycles N: stop N cycles after it (0 = at the end)
+    StimStrategy stimulus;   // --stim directed|random
+    ClockMode clocking;  // --clocking elide|two-edge|check (see clocking.h)
+    double cov_target;   // --cov-target P: end the stress test once coverage
+                         // reaches P percent (0 = always run the full budget)
+    int fault_count;             // --faults N: a fault-injection campaign of N bit flips
+                                 // over --cycles cycles instead of the tests (needs a
+                                 // FAULTS=1 build, see fault_inject.h)
+    int fault_window;            // --fault-window N: cycles a fault is followed for
+    int fault_interval;          // --fault-interval N: cycles between golden-run snapshots
+    unsigned fault_targets;      // --fault-targets memory,wr_ptr,rd_ptr,count_reg
+    const char* fault_log;       // --fault-log FILE: one CSV row per fault
+};
 
-    void print_report() {
-        printf("\n========== Coverage Report ==========\n");
-        printf("Empty state:           %s\n", seen_empty ? "HIT" : "MISS");
-        printf("Full state:            %s\n", seen_full ? "HIT" : "MISS");
-        printf("Write when full:       %s\n", seen_write_when_full ? "HIT" : "MISS");
-        printf("Read when empty:       %s\n", seen_read_when_empty ? "HIT" : "MISS");
-        printf("Simultaneous R/W:      %s\n", seen_simultaneous_rw ? "HIT" : "MISS");
-        printf("Pointer rollover:      %s\n", seen_rollover ? "HIT" : "MISS");
-        printf("\nCount distribution:\n");
-        for (int i = 0; i <= 8; i++) {
-            printf("  count=%d: %d samples\n", i, count_bins[i]);
+// Value of "--name N" on the command line, or fallback if absent
+int arg_int(int argc, char** argv, const char* name, int fallback) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return atoi(argv[i + 1]);
+    }
+    return fallback;
+}
+
+// Whether "--name" is on the command line
+bool arg_flag(int argc, char** argv, const char* name) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+// Value of "--name TEXT" on the command line, or fallback if absent
+const char* arg_str(int argc, char** argv, const char* name, const char* fallback) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return argv[i + 1];
+    }
+    return fallback;
+}
+
+TbOptions parse_options(int argc, char** argv) {
+    TbOptions opts;
+    const char* seed = arg_str(argc, argv, "--seed", NULL);
+    opts.base_seed = seed ? strtoull(seed, NULL, 0) : (uint64_t)time(NULL);
+    opts.num_seeds = arg_int(argc, argv, "--seeds", 1);
+
+    if (const char* range = arg_str(argc, argv, "--seed-range", NULL)) {
+        char* end;
+        uint64_t first = strtoull(range, &end, 0);
+        uint64_t last = *end == ':' ? strtoull(end + 1, NULL, 0) : first;
+        if (last < first || last - first >= INT32_MAX) {
+            fprintf(stderr, "Bad --seed-range '%s' (expected FIRST:LAST)\n", range);
+            exit(1);
         }
+        opts.base_seed = first;
+        opts.num_seeds = (int)(last - first + 1);
+    }
+    opts.num_jobs = arg_int(argc, argv, "--jobs", 0);
+    opts.num_lanes = arg_int(argc, argv, "--lanes", 1);
+    opts.fork = arg_flag(argc, argv, "--fork");
+    opts.random_cycles = arg_int(argc, argv, "--cycles", 10000);
+    opts.burst_cycles = arg_int(argc, argv, "--burst-cycles", 0);
+    opts.cov_out = arg_str(argc, argv, "--cov-out", NULL);
+    opts.cov_target = atof(arg_str(argc, argv, "--cov-target", "100"));
+    opts.trace_path = arg_str(argc, argv, "--trace", NULL);
+    opts.flight_cycles = arg_int(argc, argv, "--flight", 0);
+    opts.summary_path = arg_str(argc, argv, "--summary", NULL);
+    opts.result_path = arg_str(argc, argv, "--result", NULL);
+    opts.checkpoint_path = arg_str(argc, argv, "--checkpoint", NULL);
+    opts.checkpoint_every = arg_int(argc, argv, "--checkpoint-every", 100000);
+    opts.restore_path = arg_str(argc, argv, "--restore", NULL);
+    opts.phases_path = arg_str(argc, argv, "--phases", NULL);
+    opts.phase_counters = arg_flag(argc, argv, "--phase-counters");
+    opts.replay_path = arg_str(argc, argv, "--replay", NULL);
+    opts.replay_from = strtoull(arg_str(argc, argv, "--replay-from", "0"), NULL, 0);
+    opts.replay_cycles = strtoull(arg_str(argc, argv, "--replay-cycles", "0"), NULL, 0);
+    // A restored run is for looking at the failure, so it is always traced
+    // (and, see burst_per_cycle below, every cycle of it)
+    static std::string restore_trace;
+    if (opts.restore_path && !opts.trace_path) {
+        restore_trace = std::string(opts.restore_path) + ".trace";
+        opts.trace_path = restore_trace.c_str();
+    }
+    opts.fault_count = arg_int(argc, argv, "--faults", 0);
+    opts.fault_window = arg_int(argc, argv, "--fault-window", 10000);
+    opts.fault_interval = arg_int(argc, argv, "--fault-interval", 1024);
+    opts.fault_log = arg_str(argc, argv, "--fault-log", NULL);
+#ifndef TB_PHASES
+    if (opts.phases_path || opts.phase_counters) {
+        fprintf(stderr, "--phases/--phase-counters need a build with -DTB_PHASES (make ... PHASES=1)\n");
+        exit(1);
+    }
+#endif
+    if (opts.phase_counters) phase_enable_counters();
+#ifndef TB_FAULTS
+    if (opts.fault_count > 0) {
+        fprintf(stderr, "--faults needs a model Verilated with --public-flat-rw (make ... FAULTS=1)\n");
+        exit(1);
+    }
+#endif
+#ifndef TB_CHECKPOINT
+    if (opts.checkpoint_path || opts.restore_path) {
+        fprintf(stderr, "--checkpoint/--restore need a model Verilated with --savable "
+                        "(and -DTB_CHECKPOINT)\n");
+        exit(1);
+    }
+#endif
 
-        int hits = (seen_empty ? 1 : 0) + (seen_full ? 1 : 0) +
-                   (seen_write_when_full ? 1 : 0) + (seen_read_when_empty ? 1 : 0) +
-                   (seen_simultaneous_rw ? 1 : 0) + (seen_rollover ? 1 : 0);
-        printf("\nCoverage: %d/6 bins hit (%.1f%%)\n", hits, hits * 100.0 / 6);
+    const char* level = arg_str(argc, argv, "--log-level", "info");
+    opts.log_level = parse_log_level(level);
+    if (opts.log_level < 0) {
+        fprintf(stderr, "Unknown --log-level '%s' (expected error, info or debug)\n", level);
+        exit(1);
+    }
+
+    const char* clocking = arg_str(argc, argv, "--clocking", "elide");
+    int mode = parse_clock_mode(clocking);
+    if (mode < 0) {
+        fprintf(stderr, "Unknown --clocking '%s' (expected elide, two-edge or check)\n", clocking);
+        exit(1);
+    }
+    opts.clocking = (ClockMode)mode;
+
+    const char* stim = arg_str(argc, argv, "--stim", "directed");
+    if (strcmp(stim, "directed") == 0) {
+        opts.stimulus = STIM_DIRECTED;
+    } else if (strcmp(stim, "random") == 0) {
+        opts.stimulus = STIM_RANDOM;
+    } else {
+        fprintf(stderr, "Unknown --stim '%s' (expected directed or random)\n", stim);
+        exit(1);
+    }
+
+    const char* burst_check = arg_str(argc, argv, "--burst-check", "boundary");
+    if (strcmp(burst_check, "boundary") != 0 && strcmp(burst_check, "cycle") != 0) {
+        fprintf(stderr, "Unknown --burst-check '%s' (expected boundary or cycle)\n", burst_check);
+        exit(1);
+    }
+    opts.burst_per_cycle = strcmp(burst_check, "cycle") == 0 || opts.trace_path;
+
+    const char* targets = arg_str(argc, argv, "--fault-targets", "memory,wr_ptr,rd_ptr,count_reg");
+    opts.fault_targets = fault_parse_targets(targets);
+    if (opts.fault_targets == 0) {
+        fprintf(stderr, "Unknown --fault-targets '%s' (expected a list of memory, wr_ptr, rd_ptr "
+                        "and count_reg)\n", targets);
+        exit(1);
+    }
+
+    if (opts.num_seeds < 1) opts.num_seeds = 1;
+    if (opts.num_jobs < 1) opts.num_jobs = std::thread::hardware_concurrency();
+    if (opts.num_jobs < 1) opts.num_jobs = 1;
+    if (opts.num_lanes < 1) opts.num_lanes = 1;
+    if (opts.num_lanes > opts.num_seeds) opts.num_lanes = opts.num_seeds;
+    int groups = (opts.num_seeds + opts.num_lanes - 1) / opts.num_lanes;
+    if (!opts.fork && opts.fault_count == 0 && opts.num_jobs > groups) opts.num_jobs = groups;
+    if (opts.random_cycles < 0) opts.random_cycles = 0;
+    if (opts.flight_cycles < 0) opts.flight_cycles = 0;
+    if (opts.checkpoint_every < 1) opts.checkpoint_every = 1;
+    if (opts.restore_path && opts.num_seeds > 1) {
+        fprintf(stderr, "--restore resumes a single seed; drop --seeds/--seed-range\n");
+        exit(1);
+    }
+    if (opts.checkpoint_path && opts.num_lanes > 1) {
+        fprintf(stderr, "--checkpoint is not supported with --lanes\n");
+        exit(1);
+    }
+    if (opts.fork && (opts.num_lanes > 1 || opts.restore_path)) {
+        fprintf(stderr, "--fork cannot be combined with --lanes or --restore\n");
+        exit(1);
+    }
+    if (opts.replay_path && (opts.num_seeds > 1 || opts.fork || opts.restore_path || opts.checkpoint_path)) {
+        fprintf(stderr, "--replay runs one recorded stream; drop --seeds/--fork/--restore/--checkpoint\n");
+        exit(1);
+    }
+    if (opts.fault_count > 0 && (opts.num_seeds > 1 || opts.fork || opts.restore_path || opts.replay_path ||
+                                 opts.checkpoint_path || opts.trace_path)) {
+        fprintf(stderr, "--faults runs one campaign on one seed; drop --seeds/--fork/--restore/--replay/"
+                        "--checkpoint/--trace\n");
+        exit(1);
+    }
+    if (opts.fault_window < 1) opts.fault_window = 1;
+    if (opts.fault_interval < 1) opts.fault_interval = 1;
+    return opts;
+}
+
+// Cycles the DUT runs ahead of the reference model in batched lock-step
+// (a multiple of 128, so a whole batch of random words fills in 4-word steps)
+const int BATCH_CYCLES = 4096;
+
+// Independent random streams of each seed
+enum { STREAM_CONTROL, STREAM_STIMULUS, STREAM_FAULTS };
+
+// Per-transaction messages kept for formatting if a seed fails
+const int EVENT_LOG_SIZE = 256;
+
+// Every DUT output folded into one word, for --clocking check
+uint64_t fifo_output_fingerprint(const Vfifo* dut) {
+    return ((uint64_t)dut->data_out * 0x9e3779b97f4a7c15ull) ^
+           ((uint64_t)dut->count << 2 | (uint64_t)dut->full << 1 | dut->empty);
+}
+
+// Protocol properties of the testbench's own, checked next to the RTL's
+// assertions (see fifo_monitor.h): whatever the FIFO held before, a write
+// without a read leaves data queued and a read without a write leaves room
+bool write_leaves_data(const MonitorView& v, size_t i) {
+    return (v.in[i].wr_en == 0) | (v.in[i].rd_en != 0) | (v.empty[i] == 0);
+}
+bool read_leaves_room(const MonitorView& v, size_t i) {
+    return (v.in[i].rd_en == 0) | (v.in[i].wr_en != 0) | (v.full[i] == 0);
+}
+const int MON_WRITE_LEAVES_DATA = monitor_register("write_leaves_data",
+    "Write without read left the FIFO empty", monitor_block<write_leaves_data>);
+const int MON_READ_LEAVES_ROOM = monitor_register("read_leaves_room",
+    "Read without write left the FIFO full", monitor_block<read_leaves_room>);
+
+// =============================================================================
+// Test Context - everything one seed needs; never shared between threads
+// =============================================================================
+struct TestContext {
+    Vfifo* dut;
+    FifoModel* model;
+    const TbOptions* opts;
+    uint64_t seed;
+    EdgeClock<Vfifo> clock;
+    LatencyChecker latency;
+    CoverageTracker coverage;
+    FifoMonitor monitor;
+    TraceWriter* trace;       // NULL unless --trace
+    StimReplay* replay;       // NULL unless --replay
+    Xoshiro256 rng;           // decisions: goals, bursts
+    Xoshiro256x4 stim_rng;    // bulk stimulus, a whole batch per call
+
+    // Pre-generated random stimulus for one batch: data_in per cycle, and
+    // two coin-flip bits per cycle packed 32 cycles to a word
+    std::vector<uint64_t> rand_data;
+    std::vector<uint64_t> rand_coins;
+
+    // Batched lock-step buffers: applied stimulus, DUT and model outputs,
+    // and the scoreboard's per-cycle mismatch bitmap
+    std::vector<FifoStim> stim;
+    FifoOutputs rtl_out;
+    FifoOutputs ref_out;
+    std::vector<uint64_t> mismatch;
+
+    int cycle;
+    int closure_cycle;   // cycle the coverage target was reached, -1 if not
+    int total_errors;
+    int writes_completed;
+    int reads_completed;
+    int log_level;
+    EventLog events;
+    bool failure_captured;
+
+    // Checkpoints: file to write (empty if off), and the stress test
+    // progress a restored context resumes from
+    std::string checkpoint_file;
+    bool restored;
+    int stress_done;
+    std::vector<uint64_t> gen_state;
+
+    TestContext(Vfifo* d, FifoModel* m, const TbOptions* o, uint64_t s, int level) :
+        dut(d), model(m), opts(o), seed(s), clock(d, o->clocking, fifo_output_fingerprint),
+        latency(MAX_LATENCY, FIFO_DEPTH),
+        trace(NULL), replay(NULL),
+        rng(seed, STREAM_CONTROL), stim_rng(seed, STREAM_STIMULUS),
+        rand_data(BATCH_CYCLES), rand_coins(BATCH_CYCLES / 32),
+        stim(BATCH_CYCLES), rtl_out(BATCH_CYCLES), ref_out(BATCH_CYCLES),
+        mismatch((BATCH_CYCLES + 63) / 64),
+        cycle(0), closure_cycle(-1), total_errors(0), writes_completed(0), reads_completed(0),
+        log_level(level), events(EVENT_LOG_SIZE), failure_captured(false),
+        restored(false), stress_done(0) {
+        latency.set_log_level(level);
+    }
+
+    // Progress output (info level) - suppressed when many seeds run at once
+    void log(const char* fmt, ...) {
+        if (TB_LOG_MAX < TB_LOG_INFO || log_level < TB_LOG_INFO) return;
+        va_list args;
+        va_start(args, fmt);
+        vprintf(fmt, args);
+        va_end(args);
     }
 
-    int get_coverage_percent() {
-        int hits = (seen_empty ? 1 : 0) + (seen_full ? 1 : 0) +
-                   (seen_write_when_full ? 1 : 0) + (seen_read_when_empty ? 1 : 0) +
-                   (seen_simultaneous_rw ? 1 : 0) + (seen_rollover ? 1 : 0);
-        return hits * 100 / 6;
+    // Per-transaction message: buffered, and only printed now at debug level.
+    // Arguments are formatted as unsigned long long (see EventLog).
+    void event(const char* fmt, uint64_t a = 0, uint64_t b = 0, uint64_t c = 0) {
+        TB_PHASE(PH_LOG);
+        events.record(cycle, fmt, a, b, c);
+        if (TB_LOG_MAX >= TB_LOG_DEBUG && log_level >= TB_LOG_DEBUG) {
+            printf("  ");
+            printf(fmt, (unsigned long long)a, (unsigned long long)b, (unsigned long long)c);
+        }
     }
 };
 
 // =============================================================================
-// Clock cycle helper
+// Cycle trace
 // =============================================================================
-void tick(Vfifo* dut, int& cycle) {
-    dut->clk = 1;
-    dut->eval();
-    fifo_tick();
-    dut->clk = 0;
-    dut->eval();
-    cycle++;
+const int COUNT_BITS = 32 - __builtin_clz(FIFO_DEPTH);
+
+std::vector<TraceSignal> fifo_trace_signals() {
+    return {
+        {"wr_en", 1}, {"rd_en", 1}, {"rst_n", 1}, {"data_in", FIFO_DATA_WIDTH},
+        {"data_out", FIFO_DATA_WIDTH}, {"count", COUNT_BITS}, {"full", 1}, {"empty", 1},
+        {"ref_data_out", FIFO_DATA_WIDTH}, {"ref_count", COUNT_BITS}, {"ref_full", 1},
+        {"ref_empty", 1},
+    };
+}
+
+// Inputs applied before the edge, DUT and model outputs after it
+void trace_cycle(TestContext& t, int cycle, const FifoStim& in, const FifoOut& rtl,
+                 const FifoOut& ref) {
+    TB_PHASE(PH_TRACE);
+    uint64_t v[12] = {
+        in.wr_en, in.rd_en, in.rst_n, in.data_in,
+        rtl.data_out, rtl.count, rtl.full, rtl.empty,
+        ref.data_out, ref.count, ref.full, ref.empty,
+    };
+    t.trace->sample(cycle, v);
+}
+
+// First failure of a seed: have the flight recorder write out the cycles
+// that led up to it and format the buffered transaction messages
+void capture_failure(TestContext& t) {
+    if (t.failure_captured) return;
+    t.failure_captured = true;
+
+    if (t.trace && t.trace->trigger()) {
+        printf("  [TRACE] Last %llu cycles (from cycle %llu) written to %s\n",
+               (unsigned long long)t.trace->flight_size(),
+               (unsigned long long)t.trace->first_flight_cycle(), t.trace->get_path());
+    }
+    if (t.log_level < TB_LOG_DEBUG && t.events.size() > 0) {
+        printf("  [EVENTS] Last %llu transactions of seed %llu before the failure:\n",
+               (unsigned long long)t.events.size(), (unsigned long long)t.seed);
+        t.events.dump(stdout, "    ");
+    }
+}
+
+// =============================================================================
+// Clock cycle helpers
+// =============================================================================
+
+// One rising edge on the DUT only (the model is stepped separately in batches)
+void tick_dut(TestContext& t) {
+    TB_PHASE(PH_EVAL);
+    if (!t.clock.tick()) {
+        printf("  [CLOCK] Cycle %d: the falling edge changed the DUT, edge elision is not safe\n",
+               t.cycle + 1);
+        t.total_errors++;
+        capture_failure(t);
+    }
+    t.cycle++;
+}
+
+// DUT outputs in the same record layout the model produces
+void sample_outputs(Vfifo* dut, FifoOut* out) {
+    out->data_out = dut->data_out;
+    out->count = dut->count;
+    out->full = dut->full;
+    out->empty = dut->empty;
+}
+
+// Protocol monitors on one cycle, with the inputs applied before its edge
+void monitor_cycle(TestContext& t, const FifoStim& in, const FifoOut& rtl) {
+    TB_PHASE(PH_MONITOR);
+    MonitorView v = {&in, &rtl.data_out, &rtl.count, &rtl.full, &rtl.empty};
+    if (t.monitor.check(v, 0, 1, t.cycle)) capture_failure(t);
+}
+
+void tick(TestContext& t) {
+    FifoStim in = {};
+    in.data_in = t.dut->data_in;
+    in.wr_en = t.dut->wr_en;
+    in.rd_en = t.dut->rd_en;
+    in.rst_n = t.dut->rst_n;
+    tick_dut(t);
+    {
+        TB_PHASE(PH_MODEL);
+        t.model->tick();
+    }
+
+    FifoOut rtl;
+    sample_outputs(t.dut, &rtl);
+    monitor_cycle(t, in, rtl);
+    if (!t.trace) return;
+
+    FifoOut ref;
+    t.model->get_outputs(&ref);
+    trace_cycle(t, t.cycle, in, rtl, ref);
 }
 
 // =============================================================================
 // Compare RTL vs Reference Model
 // =============================================================================
-int compare_outputs(Vfifo* dut, int cycle) {
+int compare_record(const FifoOut& rtl, const FifoOut& ref, int cycle) {
     int errors = 0;
 
-    unsigned char rtl_data_out = dut->data_out;
-    unsigned char ref_data_out = fifo_get_data_out();
-    bool rtl_full = dut->full;
-    bool ref_full = fifo_get_full();
-    bool rtl_empty = dut->empty;
-    bool ref_empty = fifo_get_empty();
-    int rtl_count = dut->count;
-    size_t ref_count = fifo_get_count();
-
-    if (rtl_full != ref_full) {
-        printf("  [MISMATCH] Cycle %d: full - RTL=%d, REF=%d\n", cycle, rtl_full, ref_full);
+    if (rtl.full != ref.full) {
+        printf("  [MISMATCH] Cycle %d: full - RTL=%d, REF=%d\n", cycle, rtl.full, ref.full);
         errors++;
     }
-    if (rtl_empty != ref_empty) {
-        printf("  [MISMATCH] Cycle %d: empty - RTL=%d, REF=%d\n", cycle, rtl_empty, ref_empty);
+    if (rtl.empty != ref.empty) {
+        printf("  [MISMATCH] Cycle %d: empty - RTL=%d, REF=%d\n", cycle, rtl.empty, ref.empty);
         errors++;
     }
-    if (rtl_count != (int)ref_count) {
-        printf("  [MISMATCH] Cycle %d: count - RTL=%d, REF=%zu\n", cycle, rtl_count, ref_count);
+    if (rtl.count != ref.count) {
+        printf("  [MISMATCH] Cycle %d: count - RTL=%u, REF=%u\n", cycle, rtl.count, ref.count);
         errors++;
     }
     // Only compare data_out when not empty
-    if (!rtl_empty && rtl_data_out != ref_data_out) {
-        printf("  [MISMATCH] Cycle %d: data_out - RTL=%d, REF=%d\n", cycle, rtl_data_out, ref_data_out);
+    if (!rtl.empty && rtl.data_out != ref.data_out) {
+        printf("  [MISMATCH] Cycle %d: data_out - RTL=%llu, REF=%llu\n", cycle,
+               (unsigned long long)rtl.data_out, (unsigned long long)ref.data_out);
         errors++;
     }
 
     return errors;
 }
 
+int compare_outputs(TestContext& t) {
+    TB_PHASE(PH_COMPARE);
+    FifoOut rtl, ref;
+    sample_outputs(t.dut, &rtl);
+    t.model->get_outputs(&ref);
+    int errors = compare_record(rtl, ref, t.cycle);
+    if (errors) capture_failure(t);
+    return errors;
+}
+
+// Trace entries [begin, end) of the current batch
+void trace_batch(TestContext& t, int begin, int end, int first_cycle) {
+    for (int i = begin; i < end; i++) {
+        trace_cycle(t, first_cycle + i + 1, t.stim[i], t.rtl_out.at(i), t.ref_out.at(i));
+    }
+}
+
+// Compare n recorded cycles in one vectorized pass; entry i was captured after
+// cycle first_cycle + i + 1. Diagnostics are only built for flagged cycles.
+int compare_batch(TestContext& t, int n, int first_cycle) {
+    TB_PHASE(PH_COMPARE);
+    size_t flagged = scoreboard_compare(t.rtl_out, t.ref_out, n, t.mismatch.data());
+
+    // The flight recorder is triggered right after the first bad cycle
+    if (t.trace) {
+        int stop = n;
+        for (int w = 0; flagged && w < (n + 63) / 64; w++) {
+            if (t.mismatch[w]) {
+                stop = w * 64 + __builtin_ctzll(t.mismatch[w]) + 1;
+                break;
+            }
+        }
+        trace_batch(t, 0, stop, first_cycle);
+        if (flagged) capture_failure(t);
+        trace_batch(t, stop, n, first_cycle);
+    }
+    if (flagged == 0) return 0;
+
+    int errors = 0;
+    for (int w = 0; w < (n + 63) / 64; w++) {
+        for (uint64_t bits = t.mismatch[w]; bits != 0; bits &= bits - 1) {
+            int i = w * 64 + __builtin_ctzll(bits);
+            errors += compare_record(t.rtl_out.at(i), t.ref_out.at(i), first_cycle + i + 1);
+        }
+    }
+    capture_failure(t);
+    return errors;
+}
+
+// Protocol monitors over n recorded cycles: inputs in, DUT outputs in
+// t.rtl_out, entry i captured after cycle first_cycle + i + 1
+void monitor_batch(TestContext& t, const FifoStim* in, int n, int first_cycle) {
+    TB_PHASE(PH_MONITOR);
+    if (t.monitor.check(monitor_view(in, t.rtl_out), 0, n, first_cycle + 1)) capture_failure(t);
+}
+
 // =============================================================================
-// Main Testbench
+// Checkpoints - taken at batch boundaries of the stress test, where DUT and
+// model are in step, for as long as the seed passes; so the file on disk is
+// always the last one before the first failure
 // =============================================================================
-int main(int argc, char** argv) {
-    Verilated::commandArgs(argc, argv);
-    srand(time(NULL));
-
-    Vfifo* dut = new Vfifo;
-    fifo_init();
+enum {
+    CKPT_HEADER,      // depth, width, seed, cycle, stress cycles done, closure, errors, writes, reads
+    CKPT_MODEL,
+    CKPT_RNG,
+    CKPT_STIM_RNG,
+    CKPT_GENERATOR,
+    CKPT_LATENCY,
+    CKPT_COVERAGE,
+};
 
-    LatencyChecker latency(20);  // Max 20 cycles latency allowed
-    CoverageTracker coverage;
+#ifdef TB_CHECKPOINT
+void save_checkpoint(TestContext& t, const StimulusGenerator& gen, int done) {
+    CheckpointData c;
+    c.section(CKPT_HEADER) = {FIFO_DEPTH, FIFO_DATA_WIDTH, t.seed, (uint64_t)t.cycle, (uint64_t)done,
+                              (uint64_t)(int64_t)t.closure_cycle, (uint64_t)t.total_errors,
+                              (uint64_t)t.writes_completed, (uint64_t)t.reads_completed};
+    t.model->save_state(c.section(CKPT_MODEL));
+    t.rng.save_state(c.section(CKPT_RNG));
+    t.stim_rng.save_state(c.section(CKPT_STIM_RNG));
+    gen.save_state(c.section(CKPT_GENERATOR));
+    t.latency.save_state(c.section(CKPT_LATENCY));
+    t.coverage.save_state(c.section(CKPT_COVERAGE));
+    if (!checkpoint_save(t.checkpoint_file.c_str(), c, *t.dut)) {
+        printf("  [ERROR] Could not write checkpoint %s\n", t.checkpoint_file.c_str());
+    }
+}
 
-    int cycle = 0;
-    int total_errors = 0;
-    int writes_completed = 0;
-    int reads_completed = 0;
+// Load a checkpoint into a freshly constructed context; the stress test then
+// picks up where it was taken
+bool load_checkpoint(TestContext& t, const char* path) {
+    CheckpointReader r;
+    if (!r.open(path)) {
+        printf("[ERROR] %s is not a readable checkpoint\n", path);
+        return false;
+    }
+    const CheckpointData& c = r.sections();
+    const std::vector<uint64_t>& h = c.get(CKPT_HEADER);
+    if (h.size() != 9 || h[0] != FIFO_DEPTH || h[1] != FIFO_DATA_WIDTH) {
+        printf("[ERROR] %s was not taken with DEPTH=%d DATA_WIDTH=%d\n", path, FIFO_DEPTH,
+               FIFO_DATA_WIDTH);
+        return false;
+    }
+    r.restore_dut(*t.dut);
+
+    t.seed = h[2];
+    t.cycle = (int)h[3];
+    t.stress_done = (int)h[4];
+    t.closure_cycle = (int)(int64_t)h[5];
+    t.total_errors = (int)h[6];
+    t.writes_completed = (int)h[7];
+    t.reads_completed = (int)h[8];
+    t.gen_state = c.get(CKPT_GENERATOR);
+    t.restored = true;
+
+    bool ok = t.model->restore_state(c.get(CKPT_MODEL)) && t.rng.restore_state(c.get(CKPT_RNG)) &&
+              t.stim_rng.restore_state(c.get(CKPT_STIM_RNG)) &&
+              t.latency.restore_state(c.get(CKPT_LATENCY)) &&
+              t.coverage.restore_state(c.get(CKPT_COVERAGE));
+    if (!ok) printf("[ERROR] %s is incomplete or from a different build\n", path);
+    return ok;
+}
+#else
+void save_checkpoint(TestContext&, const StimulusGenerator&, int) {}
+bool load_checkpoint(TestContext&, const char*) { return false; }
+#endif
 
-    printf("==============================================\n");
-    printf("  FIFO Verification with Latency Checking\n");
-    printf("==============================================\n\n");
+// =============================================================================
+// Directed and Random Tests
+// =============================================================================
+void run_reset(TestContext& t) {
+    Vfifo* dut = t.dut;
+    FifoModel& model = *t.model;
 
-    // -------------------------------------------------------------------------
-    // Reset Sequence
-    // -------------------------------------------------------------------------
-    printf("[TEST] Reset sequence...\n");
+    t.log("[TEST] Reset sequence...\n");
     dut->clk = 0;
     dut->rst_n = 0;
     dut->wr_en = 0;
     dut->rd_en = 0;
     dut->data_in = 0;
-    dut->eval();
+    t.clock.settle();
 
-    fifo_set_reset(false);
-    fifo_set_wr_en(false);
-    fifo_set_rd_en(false);
-    fifo_set_data_in(0);
+    model.set_reset(false);
+    model.set_wr_en(false);
+    model.set_rd_en(false);
+    model.set_data_in(0);
 
     for (int i = 0; i < 5; i++) {
-        tick(dut, cycle);
+        tick(t);
     }
 
     // Release reset
     dut->rst_n = 1;
-    fifo_set_reset(true);
-    dut->eval();
+    model.set_reset(true);
+    t.clock.settle();
 
-    total_errors += compare_outputs(dut, cycle);
-    printf("  Reset complete. FIFO should be empty.\n");
-    printf("  RTL: empty=%d, full=%d, count=%d\n", dut->empty, dut->full, dut->count);
+    t.total_errors += compare_outputs(t);
+    t.log("  Reset complete. FIFO should be empty.\n");
+    t.log("  RTL: empty=%d, full=%d, count=%d\n", dut->empty, dut->full, dut->count);
+}
 
-    // -------------------------------------------------------------------------
-    // Test 1: Basic Write/Read
-    // -------------------------------------------------------------------------
-    printf("\n[TEST] Basic write/read sequence...\n");
+// Test 1: Basic Write/Read
+void test_basic_rw(TestContext& t) {
+    Vfifo* dut = t.dut;
+    FifoModel& model = *t.model;
+
+    t.log("\n[TEST] Basic write/read sequence...\n");
 
     // Write 4 items
     for (int i = 0; i < 4; i++) {
-        unsigned char data = i + 1;
+        fifo_data_t data = i + 1;
         dut->wr_en = 1;
         dut->data_in = data;
-        fifo_set_wr_en(true);
-        fifo_set_data_in(data);
+        model.set_wr_en(true);
+        model.set_data_in(data);
 
-        tick(dut, cycle);
-        latency.record_write(data, cycle);
-        writes_completed++;
+        tick(t);
+        t.latency.record_write(data, t.cycle);
+        t.writes_completed++;
 
         dut->wr_en = 0;
-        fifo_set_wr_en(false);
+        model.set_wr_en(false);
 
-        total_errors += compare_outputs(dut, cycle);
-        coverage.sample(dut->empty, dut->full, dut->count, true, false);
-        printf("  Write %d: count=%d\n", data, dut->count);
+        t.total_errors += compare_outputs(t);
+        t.coverage.sample(dut->empty, dut->full, dut->count, true, false);
+        t.event("Write %llu: count=%llu\n", data, dut->count);
     }
 
     // Read 4 items
     for (int i = 0; i < 4; i++) {
         dut->rd_en = 1;
-        fifo_set_rd_en(true);
+        model.set_rd_en(true);
 
-        unsigned char data_before_read = dut->data_out;
-        tick(dut, cycle);
-        latency.check_read(data_before_read, cycle);
-        reads_completed++;
+        fifo_data_t data_before_read = dut->data_out;
+        tick(t);
+        t.latency.check_read(data_before_read, t.cycle);
+        t.reads_completed++;
 
         dut->rd_en = 0;
-        fifo_set_rd_en(false);
+        model.set_rd_en(false);
 
-        total_errors += compare_outputs(dut, cycle);
-        coverage.sample(dut->empty, dut->full, dut->count, false, true);
-        printf("  Read %d: count=%d\n", data_before_read, dut->count);
+        t.total_errors += compare_outputs(t);
+        t.coverage.sample(dut->empty, dut->full, dut->count, false, true);
+        t.event("Read %llu: count=%llu\n", data_before_read, dut->count);
     }
+}
 
-    // -------------------------------------------------------------------------
-    // Test 2: Fill to Full
-    // -------------------------------------------------------------------------
-    printf("\n[TEST] Fill FIFO to full...\n");
+// Test 2: Fill to Full, then write when full
+void test_fill_full(TestContext& t) {
+    Vfifo* dut = t.dut;
+    FifoModel& model = *t.model;
+
+    t.log("\n[TEST] Fill FIFO to full...\n");
 
-    for (int i = 0; i < 8; i++) {
-        unsigned char data = 100 + i;
+    for (int i = 0; i < FIFO_DEPTH; i++) {
+        fifo_data_t data = (100 + i) & FIFO_DATA_MASK;
         dut->wr_en = 1;
         dut->data_in = data;
-        fifo_set_wr_en(true);
-        fifo_set_data_in(data);
-
-        tick(dut, cycle);
-        if (!dut->full) {
-            latency.record_write(data, cycle);
-            writes_completed++;
+        model.set_wr_en(true);
+        model.set_data_in(data);
+
+        // Accepted if there was room before the edge (the last write fills it)
+        bool accepted = !dut->full;
+        tick(t);
+        if (accepted) {
+            t.latency.record_write(data, t.cycle);
+            t.writes_completed++;
         }
 
-        total_errors += compare_outputs(dut, cycle);
-        coverage.sample(dut->empty, dut->full, dut->count, true, false);
+        t.total_errors += compare_outputs(t);
+        t.coverage.sample(dut->empty, dut->full, dut->count, true, false);
+        t.event("Fill write %llu: count=%llu\n", data, dut->count);
     }
 
     dut->wr_en = 0;
-    fifo_set_wr_en(false);
-    printf("  FIFO full=%d, count=%d\n", dut->full, dut->count);
+    model.set_wr_en(false);
+    t.log("  FIFO full=%d, count=%d\n", dut->full, dut->count);
 
     // Try to write when full
-    printf("\n[TEST] Write when full (should be ignored)...\n");
+    t.log("\n[TEST] Write when full (should be ignored)...\n");
     dut->wr_en = 1;
-    dut->data_in = 0xFF;
-    fifo_set_wr_en(true);
-    fifo_set_data_in(0xFF);
-    tick(dut, cycle);
-    coverage.sample(dut->empty, dut->full, dut->count, true, false);
-    total_errors += compare_outputs(dut, cycle);
-    printf("  After write attempt: count=%d (should still be 8)\n", dut->count);
+    dut->data_in = FIFO_DATA_MASK;
+    model.set_wr_en(true);
+    model.set_data_in(FIFO_DATA_MASK);
+    tick(t);
+    t.coverage.sample(dut->empty, dut->full, dut->count, true, false);
+    t.total_errors += compare_outputs(t);
+    t.log("  After write attempt: count=%d (should still be %d)\n", dut->count, FIFO_DEPTH);
     dut->wr_en = 0;
-    fifo_set_wr_en(false);
+    model.set_wr_en(false);
+}
 
-    // -------------------------------------------------------------------------
-    // Test 3: Drain to Empty
-    // -------------------------------------------------------------------------
-    printf("\n[TEST] Drain FIFO to empty...\n");
+// Test 3: Drain to Empty, then read when empty
+void test_drain_empty(TestContext& t) {
+    Vfifo* dut = t.dut;
+    FifoModel& model = *t.model;
+
+    t.log("\n[TEST] Drain FIFO to empty...\n");
 
     while (!dut->empty) {
         dut->rd_en = 1;
-        fifo_set_rd_en(true);
+        model.set_rd_en(true);
 
-        unsigned char data_out = dut->data_out;
-        tick(dut, cycle);
-        latency.check_read(data_out, cycle);
-        reads_completed++;
+        fifo_data_t data_out = dut->data_out;
+        tick(t);
+        t.latency.check_read(data_out, t.cycle);
+        t.reads_completed++;
 
-        total_errors += compare_outputs(dut, cycle);
-        coverage.sample(dut->empty, dut->full, dut->count, false, true);
+        t.total_errors += compare_outputs(t);
+        t.coverage.sample(dut->empty, dut->full, dut->count, false, true);
+        t.event("Drain read %llu: count=%llu\n", data_out, dut->count);
     }
 
     dut->rd_en = 0;
-    fifo_set_rd_en(false);
-    printf("  FIFO empty=%d, count=%d\n", dut->empty, dut->count);
+    model.set_rd_en(false);
+    t.log("  FIFO empty=%d, count=%d\n", dut->empty, dut->count);
 
     // Try to read when empty
-    printf("\n[TEST] Read when empty (should be ignored)...\n");
+    t.log("\n[TEST] Read when empty (should be ignored)...\n");
     dut->rd_en = 1;
-    fifo_set_rd_en(true);
-    tick(dut, cycle);
-    coverage.sample(dut->empty, dut->full, dut->count, false, true);
-    total_errors += compare_outputs(dut, cycle);
-    printf("  After read attempt: empty=%d (should still be 1)\n", dut->empty);
+    model.set_rd_en(true);
+    tick(t);
+    t.coverage.sample(dut->empty, dut->full, dut->count, false, true);
+    t.total_errors += compare_outputs(t);
+    t.log("  After read attempt: empty=%d (should still be 1)\n", dut->empty);
     dut->rd_en = 0;
-    fifo_set_rd_en(false);
+    model.set_rd_en(false);
+}
 
-    // -------------------------------------------------------------------------
-    // Test 4: Simultaneous Read/Write
-    // -------------------------------------------------------------------------
-    printf("\n[TEST] Simultaneous read/write...\n");
+// Test 4: Simultaneous Read/Write
+void test_simultaneous_rw(TestContext& t) {
+    Vfifo* dut = t.dut;
+    FifoModel& model = *t.model;
+
+    t.log("\n[TEST] Simultaneous read/write...\n");
 
     // First put some data in
     for (int i = 0; i < 4; i++) {
-        unsigned char data = 50 + i;
+        fifo_data_t data = 50 + i;
         dut->wr_en = 1;
         dut->data_in = data;
-        fifo_set_wr_en(true);
-        fifo_set_data_in(data);
-        tick(dut, cycle);
-        latency.record_write(data, cycle);
-        writes_completed++;
-        total_errors += compare_outputs(dut, cycle);
+        model.set_wr_en(true);
+        model.set_data_in(data);
+        tick(t);
+        t.latency.record_write(data, t.cycle);
+        t.writes_completed++;
+        t.total_errors += compare_outputs(t);
     }
     dut->wr_en = 0;
-    fifo_set_wr_en(false);
+    model.set_wr_en(false);
 
     // Now do simultaneous R/W
-    printf("  Before: count=%d\n", dut->count);
+    t.log("  Before: count=%d\n", dut->count);
     for (int i = 0; i < 4; i++) {
-        unsigned char new_data = 60 + i;
-        unsigned char read_data = dut->data_out;
+        fifo_data_t new_data = 60 + i;
+        fifo_data_t read_data = dut->data_out;
 
         dut->wr_en = 1;
         dut->rd_en = 1;
         dut->data_in = new_data;
-        fifo_set_wr_en(true);
-        fifo_set_rd_en(true);
-        fifo_set_data_in(new_data);
-
-        tick(dut, cycle);
-        latency.record_write(new_data, cycle);
-        latency.check_read(read_data, cycle);
-        writes_completed++;
-        reads_completed++;
-
-        total_errors += compare_outputs(dut, cycle);
-        coverage.sample(dut->empty, dut->full, dut->count, true, true);
-        printf("  Simultaneous R/W: wrote %d, read %d, count=%d\n", new_data, read_data, dut->count);
+        model.set_wr_en(true);
+        model.set_rd_en(true);
+        model.set_data_in(new_data);
+
+        tick(t);
+        t.latency.record_write(new_data, t.cycle);
+        t.latency.check_read(read_data, t.cycle);
+        t.writes_completed++;
+        t.reads_completed++;
+
+        t.total_errors += compare_outputs(t);
+        t.coverage.sample(dut->empty, dut->full, dut->count, true, true);
+        t.event("Simultaneous R/W: wrote %llu, read %llu, count=%llu\n",
+                new_data, read_data, dut->count);
     }
     dut->wr_en = 0;
     dut->rd_en = 0;
-    fifo_set_wr_en(false);
-    fifo_set_rd_en(false);
-
-    // -------------------------------------------------------------------------
-    // Test 5: Randomized Stress Test
-    // -------------------------------------------------------------------------
-    printf("\n[TEST] Randomized stress test (100 cycles)...\n");
+    model.set_wr_en(false);
+    model.set_rd_en(false);
+}
 
-    int rand_errors = 0;
-    for (int i = 0; i < 100; i++) {
-        bool do_write = (rand() % 2) && !dut->full;
-        bool do_read = (rand() % 2) && !dut->empty;
-        unsigned char data = rand() % 256;
+// Coverage target reached? Records the cycle it first was.
+bool coverage_closed(TestContext& t) {
+    double target = t.opts->cov_target;
+    if (target <= 0 || t.coverage.get_coverage_percent() < target) return false;
+    if (t.closure_cycle < 0) t.closure_cycle = t.cycle;
+    return true;
+}
 
-        unsigned char read_data = dut->data_out;
+// Test 5: Randomized Stress Test
+// The DUT runs ahead one batch at a time, recording the stimulus it was given
+// and its outputs. The model then steps the whole batch in one call and the
+// two output streams are compared in a single pass. The test ends early once
+// the coverage target is reached.
+void test_random_stress(TestContext& t) {
+    TB_PHASE(PH_STRESS);
+    Vfifo* dut = t.dut;
+    FifoModel& model = *t.model;
+    int cycles = t.opts->random_cycles;
+    StimulusGenerator gen(t.opts->stimulus, t.coverage, t.rng);
+
+    t.log("\n[TEST] Randomized stress test (%s stimulus, up to %d cycles)...\n",
+          t.opts->stimulus == STIM_DIRECTED ? "coverage-directed" : "random", cycles);
 
-        dut->wr_en = do_write;
-        dut->rd_en = do_read;
-        dut->data_in = data;
-        fifo_set_wr_en(do_write);
-        fifo_set_rd_en(do_read);
-        fifo_set_data_in(data);
+    int rand_errors = 0;
+    int done = 0;
+    if (t.restored && gen.restore_state(t.gen_state)) {
+        done = t.stress_done;
+        t.log("  Resumed from checkpoint at cycle %d (%d stress cycles done)\n", t.cycle, done);
+    }
 
-        tick(dut, cycle);
+    int last_checkpoint = done;
+    bool closed = coverage_closed(t);
+    while (done < cycles && !closed) {
+        int n = std::min(cycles - done, BATCH_CYCLES);
+        int first_cycle = t.cycle;
+
+        bool passing = t.total_errors + rand_errors + t.latency.get_violations() +
+                       t.monitor.total_failures() == 0;
+        if (!t.checkpoint_file.empty() && passing && !t.restored &&
+            (done == 0 || done - last_checkpoint >= t.opts->checkpoint_every)) {
+            save_checkpoint(t, gen, done);
+            last_checkpoint = done;
+        }
 
-        if (do_write) {
-            latency.record_write(data, cycle);
-            writes_completed++;
+        // All of this batch's random words in one vectorized pass
+        {
+            TB_PHASE(PH_STIMULUS);
+            t.stim_rng.fill(t.rand_data.data(), n, FIFO_DATA_MASK);
+            t.stim_rng.fill(t.rand_coins.data(), (n + 31) / 32);
         }
-        if (do_read) {
-            latency.check_read(read_data, cycle);
-            reads_completed++;
+
+        int i = 0;
+        while (i < n && !closed) {
+            bool wr_en, rd_en;
+            gen.next(dut->count, t.rand_coins[i / 32] >> (2 * (i % 32)), &wr_en, &rd_en);
+            bool do_write = wr_en && !dut->full;
+            bool do_read = rd_en && !dut->empty;
+            fifo_data_t data = t.rand_data[i];
+
+            fifo_data_t read_data = dut->data_out;
+
+            dut->wr_en = wr_en;
+            dut->rd_en = rd_en;
+            dut->data_in = data;
+
+            FifoStim& s = t.stim[i];
+            s.data_in = data;
+            s.wr_en = wr_en;
+            s.rd_en = rd_en;
+            s.rst_n = dut->rst_n;
+
+            tick_dut(t);
+            FifoOut rtl;
+            sample_outputs(dut, &rtl);
+            t.rtl_out.set(i, rtl);
+            i++;
+
+            {
+                TB_PHASE(PH_LATENCY);
+                if (do_write) {
+                    t.latency.record_write(data, t.cycle);
+                    t.writes_completed++;
+                }
+                if (do_read) {
+                    t.latency.check_read(read_data, t.cycle);
+                    t.reads_completed++;
+                    // Every DEPTH reads since reset bring the read pointer back to 0
+                    if (t.reads_completed % FIFO_DEPTH == 0) t.coverage.record_rollover();
+                }
+            }
+
+            t.coverage.sample(dut->empty, dut->full, dut->count, wr_en, rd_en);
+            closed = coverage_closed(t);
         }
 
-        rand_errors += compare_outputs(dut, cycle);
-        coverage.sample(dut->empty, dut->full, dut->count, do_write, do_read);
+        {
+            TB_PHASE(PH_MODEL);
+            model.step_batch(t.stim.data(), t.ref_out.buf(), i);
+        }
+        rand_errors += compare_batch(t, i, first_cycle);
+        monitor_batch(t, t.stim.data(), i, first_cycle);
+        done += i;
     }
 
     dut->wr_en = 0;
     dut->rd_en = 0;
-    fifo_set_wr_en(false);
-    fifo_set_rd_en(false);
+    model.set_wr_en(false);
+    model.set_rd_en(false);
+
+    t.total_errors += rand_errors;
+    t.log("  Ran %d cycles, coverage %.1f%%\n", done, t.coverage.get_coverage_percent());
+    t.log("  Random test errors: %d\n", rand_errors);
+}
 
-    total_errors += rand_errors;
-    printf("  Random test errors: %d\n", rand_errors);
+// Test 6: Pointer Rollover Test
+void test_pointer_rollover(TestContext& t) {
+    Vfifo* dut = t.dut;
+    FifoModel& model = *t.model;
 
-    // -------------------------------------------------------------------------
-    // Test 6: Pointer Rollover Test
-    // -------------------------------------------------------------------------
-    printf("\n[TEST] Pointer rollover test...\n");
+    t.log("\n[TEST] Pointer rollover test...\n");
 
     // Drain any remaining data
     while (!dut->empty) {
         dut->rd_en = 1;
-        fifo_set_rd_en(true);
-        unsigned char d = dut->data_out;
-        tick(dut, cycle);
-        latency.check_read(d, cycle);
-        reads_completed++;
+        model.set_rd_en(true);
+        fifo_data_t d = dut->data_out;
+        tick(t);
+        t.latency.check_read(d, t.cycle);
+        t.reads_completed++;
     }
     dut->rd_en = 0;
-    fifo_set_rd_en(false);
+    model.set_rd_en(false);
 
-    // Write and read 20 items to force pointer wraparound
-    for (int i = 0; i < 20; i++) {
-        unsigned char data = i;
+    // Write and read enough items to force pointer wraparound (20 at depth 8)
+    for (int i = 0; i < 2 * FIFO_DEPTH + 4; i++) {
+        fifo_data_t data = i & FIFO_DATA_MASK;
 
         // Write
         dut->wr_en = 1;
         dut->data_in = data;
-        fifo_set_wr_en(true);
-        fifo_set_data_in(data);
-        tick(dut, cycle);
-        latency.record_write(data, cycle);
-        writes_completed++;
+        model.set_wr_en(true);
+        model.set_data_in(data);
+        tick(t);
+        t.latency.record_write(data, t.cycle);
+        t.writes_completed++;
         dut->wr_en = 0;
-        fifo_set_wr_en(false);
+        model.set_wr_en(false);
 
         // Read
         dut->rd_en = 1;
-        fifo_set_rd_en(true);
-        unsigned char read_data = dut->data_out;
-        tick(dut, cycle);
-        latency.check_read(read_data, cycle);
-        reads_completed++;
+        model.set_rd_en(true);
+        fifo_data_t read_data = dut->data_out;
+        tick(t);
+        t.latency.check_read(read_data, t.cycle);
+        t.reads_completed++;
         dut->rd_en = 0;
-        fifo_set_rd_en(false);
+        model.set_rd_en(false);
 
-        total_errors += compare_outputs(dut, cycle);
+        t.total_errors += compare_outputs(t);
 
         if (read_data != data) {
-            printf("  [ERROR] Rollover mismatch: wrote %d, read %d\n", data, read_data);
+            printf("  [ERROR] Rollover mismatch: wrote %llu, read %llu\n",
+                   (unsigned long long)data, (unsigned long long)read_data);
+        }
+    }
+    t.coverage.record_rollover();
+    t.log("  Pointer rollover test complete\n");
+}
+
+// Test 7: Burst Stress Test (--burst-cycles N)
+// Random-length bursts of pure writes or pure reads, some longer than the
+// FIFO has room or data for. The model takes each burst as one transaction
+// and the DUT is checked where the burst ends: its outputs, the number of
+// writes it accepted or reads it made, and the data read, in order. With
+// --burst-check cycle the model also produces every cycle's outputs and the
+// whole burst is compared like a stress test batch. Writing into a full FIFO
+// holds data far longer than MAX_LATENCY, so the latency checker sits this
+// test out; the model check covers data order.
+void test_burst_stress(TestContext& t) {
+    TB_PHASE(PH_BURSTS);
+    Vfifo* dut = t.dut;
+    FifoModel& model = *t.model;
+    int cycles = t.opts->burst_cycles;
+    bool per_cycle = t.opts->burst_per_cycle;
+    if (cycles <= 0) return;
+
+    t.log("\n[TEST] Burst stress test (up to %d cycles, checked %s)...\n", cycles,
+          per_cycle ? "every cycle" : "at burst ends");
+
+    std::vector<uint64_t> rtl_read(BATCH_CYCLES);
+    std::vector<uint64_t> ref_read(BATCH_CYCLES);
+    FifoOutBuf ref_buf = t.ref_out.buf();
+    int burst_errors = 0;
+    int bursts = 0;
+    int done = 0;
+    while (done < cycles) {
+        bool write = t.rng() & 1;
+        int n = std::min({cycles - done, BATCH_CYCLES, 1 + (int)(t.rng() % (2 * FIFO_DEPTH))});
+        int first_cycle = t.cycle;
+        if (write) {
+            TB_PHASE(PH_STIMULUS);
+            t.stim_rng.fill(t.rand_data.data(), n, FIFO_DATA_MASK);
+        }
+
+        int rtl_ops = 0;
+        dut->wr_en = write;
+        dut->rd_en = !write;
+        for (int i = 0; i < n; i++) {
+            bool do_write = write && !dut->full;
+            bool do_read = !write && !dut->empty;
+            if (write) dut->data_in = t.rand_data[i];
+            if (do_read) rtl_read[rtl_ops] = dut->data_out;
+
+            // Recorded for the monitors every cycle, even when the model is
+            // only compared at the end of the burst
+            FifoStim& s = t.stim[i];
+            s.data_in = dut->data_in;
+            s.wr_en = write;
+            s.rd_en = !write;
+            s.rst_n = dut->rst_n;
+            tick_dut(t);
+            FifoOut rtl;
+            sample_outputs(dut, &rtl);
+            t.rtl_out.set(i, rtl);
+
+            if (do_write) t.writes_completed++;
+            if (do_read) {
+                t.reads_completed++;
+                if (t.reads_completed % FIFO_DEPTH == 0) t.coverage.record_rollover();
+            }
+            rtl_ops += do_write || do_read;
+        }
+
+        const FifoOutBuf* out = per_cycle ? &ref_buf : NULL;
+        int ref_ops;
+        {
+            TB_PHASE(PH_MODEL);
+            ref_ops = (int)(write ? model.write_burst(t.rand_data.data(), n, out)
+                                  : model.read_burst(n, ref_read.data(), out));
+        }
+
+        int errors = per_cycle ? compare_batch(t, n, first_cycle) : compare_outputs(t);
+        if (rtl_ops != ref_ops) {
+            printf("  [MISMATCH] Cycle %d: %d-cycle %s burst - RTL made %d, REF %d\n", t.cycle, n,
+                   write ? "write" : "read", rtl_ops, ref_ops);
+            errors++;
+        } else {
+            for (int k = 0; k < rtl_ops && !write; k++) {
+                if (rtl_read[k] != ref_read[k]) {
+                    printf("  [MISMATCH] Cycle %d: read %d of the burst - RTL=%llu, REF=%llu\n",
+                           t.cycle, k, (unsigned long long)rtl_read[k], (unsigned long long)ref_read[k]);
+                    errors++;
+                    break;
+                }
+            }
+        }
+        if (errors) capture_failure(t);
+        monitor_batch(t, t.stim.data(), n, first_cycle);
+
+        t.coverage.sample(dut->empty, dut->full, dut->count, write, !write);
+        burst_errors += errors;
+        bursts++;
+        done += n;
+    }
+
+    dut->wr_en = 0;
+    dut->rd_en = 0;
+    model.set_wr_en(false);
+    model.set_rd_en(false);
+
+    t.total_errors += burst_errors;
+    t.log("  Ran %d bursts in %d cycles\n", bursts, done);
+    t.log("  Burst test errors: %d\n", burst_errors);
+}
+
+// Replay (--replay FILE)
+// Recorded stimulus, from the last reset at or before --replay-from, checked
+// against the model batch by batch like the stress test. The records have
+// FifoStim's layout, so the model steps straight through the mapped file.
+// Captured traffic resets with data queued and writes into a full FIFO, so
+// the latency checker sits this test out; the model check covers data order.
+static_assert(offsetof(StimRecord, data) == offsetof(FifoStim, data_in) &&
+              offsetof(StimRecord, en) == offsetof(FifoStim, wr_en) &&
+              offsetof(StimRecord, en) + 1 == offsetof(FifoStim, rd_en) &&
+              offsetof(StimRecord, rst_n) == offsetof(FifoStim, rst_n),
+              "StimRecord must have FifoStim's layout");
+
+void test_replay(TestContext& t) {
+    TB_PHASE(PH_REPLAY);
+    Vfifo* dut = t.dut;
+    FifoModel& model = *t.model;
+    StimReplay& stim = *t.replay;
+    const FifoStim* recs = reinterpret_cast<const FifoStim*>(stim.records());
+
+    uint64_t from = t.opts->replay_from > stim.first_cycle() ? t.opts->replay_from - stim.first_cycle() : 0;
+    uint64_t start = stim.seek(t.opts->replay_from);
+    uint64_t end = stim.size();
+    if (t.opts->replay_cycles > 0 && from + t.opts->replay_cycles < end) end = from + t.opts->replay_cycles;
+    // Cycle numbers are ints; longer streams are replayed in pieces with --replay-from
+    if (end - start > (uint64_t)(INT32_MAX - t.cycle)) {
+        end = start + (INT32_MAX - t.cycle);
+        printf("  [REPLAY] Stopping after %llu cycles, continue with --replay-from %llu\n",
+               (unsigned long long)(end - start), (unsigned long long)(stim.first_cycle() + end));
+    }
+
+    t.log("\n[TEST] Replay of %llu recorded cycles (file cycles %llu..%llu)...\n",
+          (unsigned long long)(end - start), (unsigned long long)(stim.first_cycle() + start),
+          (unsigned long long)(stim.first_cycle() + end - (end > start)));
+    if (start < from) t.log("  Starting at the reset ending at file cycle %llu\n",
+                            (unsigned long long)(stim.first_cycle() + start));
+
+    int replay_errors = 0;
+    for (uint64_t pos = start; pos < end;) {
+        int n = (int)std::min<uint64_t>(end - pos, BATCH_CYCLES);
+        int first_cycle = t.cycle;
+        const FifoStim* s = recs + pos;
+
+        for (int i = 0; i < n; i++) {
+            bool do_write = s[i].rst_n && s[i].wr_en && !dut->full;
+            bool do_read = s[i].rst_n && s[i].rd_en && !dut->empty;
+            dut->rst_n = s[i].rst_n;
+            dut->wr_en = s[i].wr_en;
+            dut->rd_en = s[i].rd_en;
+            dut->data_in = s[i].data_in;
+
+            tick_dut(t);
+            FifoOut rtl;
+            sample_outputs(dut, &rtl);
+            t.rtl_out.set(i, rtl);
+
+            t.writes_completed += do_write;
+            t.reads_completed += do_read;
+            t.coverage.sample(dut->empty, dut->full, dut->count, s[i].wr_en, s[i].rd_en);
+        }
+
+        {
+            TB_PHASE(PH_MODEL);
+            model.step_batch(s, t.ref_out.buf(), n);
+        }
+        // The trace reads the applied stimulus from the batch buffer
+        if (t.trace) std::copy(s, s + n, t.stim.begin());
+        replay_errors += compare_batch(t, n, first_cycle);
+        monitor_batch(t, s, n, first_cycle);
+        pos += n;
+        stim.release(pos);
+    }
+
+    dut->rst_n = 1;
+    dut->wr_en = 0;
+    dut->rd_en = 0;
+    model.set_reset(true);
+    model.set_wr_en(false);
+    model.set_rd_en(false);
+
+    t.total_errors += replay_errors;
+    t.log("  Replay errors: %d\n", replay_errors);
+}
+
+// Run the full suite for one seed on a DUT and model owned by the caller
+// (or, with --replay, the recorded stream)
+void run_seed(TestContext& t) {
+    if (t.replay) {
+        run_reset(t);
+        test_replay(t);
+    } else if (!t.restored) {
+        run_reset(t);
+        test_basic_rw(t);
+        test_fill_full(t);
+        test_drain_empty(t);
+        test_simultaneous_rw(t);
+    }
+    if (!t.replay) {
+        test_random_stress(t);
+        test_pointer_rollover(t);
+        test_burst_stress(t);
+    }
+
+    // Latency-only failures have not been captured yet
+    if (t.total_errors + t.latency.get_violations() > 0) capture_failure(t);
+}
+
+// Seeds fail on model mismatches, latency violations and assertion failures
+bool seed_failed(TestContext& t) {
+    return t.total_errors + t.latency.get_violations() + t.monitor.total_failures() > 0;
+}
+
+void print_closure(const TestContext& t) {
+    printf("Stimulus: %s, coverage target %.1f%%\n",
+           t.replay ? "replay" : t.opts->stimulus == STIM_DIRECTED ? "directed" : "random",
+           t.opts->cov_target);
+    if (t.opts->cov_target <= 0) {
+        printf("Cycles to closure: not tracked (--cov-target 0)\n");
+    } else if (t.closure_cycle >= 0) {
+        printf("Cycles to closure: %d\n", t.closure_cycle);
+    } else {
+        printf("Cycles to closure: not reached (%.1f%%)\n", t.coverage.get_coverage_percent());
+    }
+}
+
+// Trace for one seed as requested by --trace/--flight, or NULL. Regressions
+// get one file per seed; in flight recorder mode only failing seeds write one.
+TraceWriter* open_trace(const TbOptions& opts, uint64_t seed, bool per_seed) {
+    if (!opts.trace_path) return NULL;
+    std::string path = opts.trace_path;
+    if (per_seed) path += "." + std::to_string(seed);
+    return new TraceWriter(path.c_str(), fifo_trace_signals(), opts.flight_cycles);
+}
+
+// Save the coverage database for cov_merge, if --cov-out was given
+void write_coverage(CoverageTracker& coverage, const char* path) {
+    if (!path) return;
+    if (coverage.save(path)) {
+        printf("Coverage database written to %s\n", path);
+    } else {
+        printf("  [ERROR] Could not write coverage database %s\n", path);
+    }
+}
+
+// =============================================================================
+// Sharded Regression Runner
+// =============================================================================
+
+// One slot per seed, written only by the worker that ran it
+struct SeedResult {
+    uint64_t seed;
+    int cycles;
+    int closure_cycle;
+    int mismatches;
+    int latency_violations;
+    int assertion_failures;
+    int writes;
+    int reads;
+
+    bool failed() const { return mismatches + latency_violations + assertion_failures > 0; }
+};
+
+SeedResult seed_result(TestContext& t) {
+    SeedResult r;
+    r.seed = t.seed;
+    r.cycles = t.cycle;
+    r.closure_cycle = t.closure_cycle;
+    r.mismatches = t.total_errors;
+    r.latency_violations = t.latency.get_violations();
+    r.assertion_failures = (int)t.monitor.total_failures();
+    r.writes = t.writes_completed;
+    r.reads = t.reads_completed;
+    return r;
+}
+
+// --summary: one flat record for dashboards, for a single run or a regression
+void write_summary(const TbOptions& opts, const std::vector<SeedResult>& results,
+                   const LatencyChecker& latency, const CoverageTracker& coverage,
+                   const FifoMonitor& monitor, double seconds) {
+    if (!opts.summary_path) return;
+
+    long long cycles = 0, mismatches = 0, violations = 0, assertions = 0, closure_cycles = 0;
+    int closed = 0, max_closure = 0;
+    std::vector<uint64_t> failed;
+    for (const SeedResult& r : results) {
+        cycles += r.cycles;
+        mismatches += r.mismatches;
+        violations += r.latency_violations;
+        assertions += r.assertion_failures;
+        if (r.closure_cycle >= 0) {
+            closed++;
+            closure_cycles += r.closure_cycle;
+            max_closure = std::max(max_closure, r.closure_cycle);
+        }
+        if (r.failed()) failed.push_back(r.seed);
+    }
+    const LatencyHistogram& h = latency.get_histogram();
+
+    RunSummary s;
+    s.add("testbench", "tb_fifo");
+    s.add("depth", FIFO_DEPTH);
+    s.add("data_width", FIFO_DATA_WIDTH);
+    s.add("first_seed", opts.base_seed);
+    s.add("seeds", (int)results.size());
+    s.add("jobs", opts.num_seeds > 1 || opts.fork ? opts.num_jobs : 1);
+    s.add("lanes", opts.num_lanes);
+    s.add("fork", opts.fork);
+    s.add("stimulus", opts.replay_path ? "replay" : opts.stimulus == STIM_DIRECTED ? "directed" : "random");
+    s.add("clocking", clock_mode_name(opts.clocking));
+    s.add("cycles", cycles);
+    s.add("seconds", seconds);
+    s.add("mismatches", mismatches);
+    s.add("latency_violations", violations);
+    s.add("assertion_cycles", monitor.get_checked());
+    s.add("assertion_failures", assertions);
+    s.add("latency_min", h.get_min());
+    s.add("latency_max", h.get_max());
+    s.add("latency_avg", h.get_count() ? (double)h.get_sum() / h.get_count() : 0.0);
+    s.add("latency_p50", h.percentile(0.50));
+    s.add("latency_p99", h.percentile(0.99));
+    s.add("latency_p999", h.percentile(0.999));
+    s.add("coverage_percent", coverage.get_coverage_percent());
+    s.add("coverage_target", opts.cov_target);
+    s.add("seeds_closed", closed);
+    s.add("closure_cycles_avg", closed ? (double)closure_cycles / closed : 0.0);
+    s.add("closure_cycles_max", max_closure);
+    s.add("failed_seeds", failed);
+    s.add("passed", failed.empty());
+
+    if (!s.write(opts.summary_path)) {
+        fprintf(stderr, "Could not write summary %s\n", opts.summary_path);
+    }
+}
+
+// --result: every seed's outcome, the latency histogram and the coverage
+// database, for sim/dispatch to merge with other runs
+void write_result(const TbOptions& opts, const std::vector<SeedResult>& results,
+                  const LatencyChecker& latency, CoverageTracker& coverage,
+                  const FifoMonitor& monitor, double seconds) {
+    if (!opts.result_path) return;
+
+    RunResult rr;
+    rr.depth = FIFO_DEPTH;
+    rr.data_width = FIFO_DATA_WIDTH;
+    rr.seconds = seconds;
+    rr.assertion_cycles = monitor.get_checked();
+    for (const SeedResult& r : results) {
+        ResultSeed rs = {};
+        rs.seed = r.seed;
+        rs.cycles = r.cycles;
+        rs.closure_cycle = r.closure_cycle;
+        rs.mismatches = r.mismatches;
+        rs.latency_violations = r.latency_violations;
+        rs.assertion_failures = r.assertion_failures;
+        rs.writes = r.writes;
+        rs.reads = r.reads;
+        rr.seeds.push_back(rs);
+    }
+    rr.latency = latency.get_histogram();
+    rr.coverage = coverage.group();
+    if (!rr.write(opts.result_path)) {
+        fprintf(stderr, "Could not write result record %s\n", opts.result_path);
+    }
+}
+
+bool log_info(const TbOptions& opts) {
+    return TB_LOG_MAX >= TB_LOG_INFO && opts.log_level >= TB_LOG_INFO;
+}
+
+// Which clocking path runs; elision silently falls back if the model's clk
+// state was not found, so say so
+void print_clocking(const TbOptions& opts) {
+    bool fallback = opts.clocking == CLOCK_ELIDE && !EdgeClock<Vfifo>::can_elide();
+    printf("Clocking: %s%s\n", clock_mode_name(opts.clocking),
+           fallback ? " (clk edge state not found, evaluating both edges)" : "");
+}
+
+// Phase breakdown at exit, when built with -DTB_PHASES (worker threads must
+// have exited for their share to be included)
+void report_phases(const TbOptions& opts) {
+#ifdef TB_PHASES
+    PhaseReport r = phase_report();
+    if (log_info(opts)) phase_print(r);
+    if (opts.phases_path && !phase_write_json(r, opts.phases_path, "tb_fifo")) {
+        fprintf(stderr, "Could not write phase breakdown %s\n", opts.phases_path);
+    }
+#else
+    (void)opts;
+#endif
+}
+
+// Per-worker accumulators, merged by main after join
+struct ShardTotals {
+    LatencyChecker latency;
+    CoverageTracker coverage;
+    FifoMonitor monitor;
+
+    ShardTotals() : latency(MAX_LATENCY, FIFO_DEPTH) {}
+};
+
+// =============================================================================
+// Lane-batched regression (--lanes K)
+//
+// Each worker runs K seeds at once on K DUT instances in one contiguous block
+// and one FifoBank holding K reference FIFOs. Every cycle drives each lane's DUT in turn (one
+// eval() per instance, so all K stay hot in cache), steps every model lane
+// in one vectorized pass and compares the K output pairs with the scoreboard
+// kernel. Lanes run the reset sequence and the randomized stress test only
+// (no --trace or event log); a lane that reaches the coverage target drops
+// out while the rest go on.
+// A lane's stimulus depends only on its seed, not on K.
+// =============================================================================
+
+// Cycles of random stimulus generated per lane at a time
+const int LANE_BLOCK = 256;
+
+// A worker's K DUTs, side by side in one cache-line aligned block (placement
+// new, so the models cannot be copied or moved once built)
+class LaneDuts {
+private:
+    static constexpr size_t ALIGN = alignof(Vfifo) > 64 ? alignof(Vfifo) : 64;
+    void* block;
+    int count;
+
+public:
+    LaneDuts(int k, VerilatedContext* context) : count(0) {
+        size_t bytes = (k * sizeof(Vfifo) + ALIGN - 1) / ALIGN * ALIGN;
+        block = aligned_alloc(ALIGN, bytes);
+        if (!block) throw std::bad_alloc();
+        for (; count < k; count++) new (at(count)) Vfifo(context);
+    }
+    ~LaneDuts() {
+        while (count > 0) at(--count)->~Vfifo();
+        free(block);
+    }
+    LaneDuts(const LaneDuts&) = delete;
+    LaneDuts& operator=(const LaneDuts&) = delete;
+
+    Vfifo* at(int l) { return static_cast<Vfifo*>(block) + l; }
+};
+
+struct Lane {
+    uint64_t seed;
+    Vfifo* dut;
+    EdgeClock<Vfifo> clock;
+    Xoshiro256 rng;
+    Xoshiro256x4 stim_rng;
+    CoverageTracker coverage;
+    LatencyChecker latency;
+    FifoMonitor monitor;
+    StimulusGenerator gen;
+    std::vector<uint64_t> rand_data;
+    std::vector<uint64_t> rand_coins;
+    int cycle;
+    int closure_cycle;
+    int errors;
+    int writes;
+    int reads;
+    bool active;
+
+    Lane(Vfifo* d, const TbOptions& opts, uint64_t s) :
+        seed(s), dut(d), clock(d, opts.clocking, fifo_output_fingerprint),
+        rng(s, STREAM_CONTROL), stim_rng(s, STREAM_STIMULUS),
+        latency(MAX_LATENCY, FIFO_DEPTH), gen(opts.stimulus, coverage, rng),
+        rand_data(LANE_BLOCK), rand_coins(LANE_BLOCK / 32),
+        cycle(0), closure_cycle(-1), errors(0), writes(0), reads(0), active(true) {
+        latency.set_log_level(TB_LOG_ERROR);
+    }
+};
+
+// Buffers shared by every lane group a worker runs; entry l of each
+// FifoOutputs is lane l (not a cycle, as elsewhere)
+struct LaneBuffers {
+    FifoBank bank;
+    std::vector<FifoStim> stim;
+    FifoOutputs rtl_out;
+    FifoOutputs ref_out;
+    std::vector<uint64_t> mismatch;
+
+    explicit LaneBuffers(size_t k) :
+        bank(k), stim(k), rtl_out(k), ref_out(k), mismatch((k + 63) / 64) {}
+};
+
+// Drive one cycle of an active lane and record its outputs in entry l
+void step_lane(Lane& L, int l, int i, LaneBuffers& b) {
+    Vfifo* dut = L.dut;
+    bool wr_en, rd_en;
+    L.gen.next(dut->count, L.rand_coins[i / 32] >> (2 * (i % 32)), &wr_en, &rd_en);
+    bool do_write = wr_en && !dut->full;
+    bool do_read = rd_en && !dut->empty;
+    fifo_data_t data = L.rand_data[i];
+    fifo_data_t read_data = dut->data_out;
+
+    dut->wr_en = wr_en;
+    dut->rd_en = rd_en;
+    dut->data_in = data;
+    FifoStim& s = b.stim[l];
+    s.data_in = data;
+    s.wr_en = wr_en;
+    s.rd_en = rd_en;
+
+    bool clock_ok;
+    {
+        TB_PHASE(PH_EVAL);
+        clock_ok = L.clock.tick();
+    }
+    if (!clock_ok) {
+        printf("  [CLOCK] Seed %llu, cycle %d: the falling edge changed the DUT, edge elision is not safe\n",
+               (unsigned long long)L.seed, L.cycle + 1);
+        L.errors++;
+    }
+    L.cycle++;
+    FifoOut o;
+    sample_outputs(dut, &o);
+    b.rtl_out.set(l, o);
+
+    {
+        TB_PHASE(PH_LATENCY);
+        if (do_write) {
+            L.latency.record_write(data, L.cycle);
+            L.writes++;
+        }
+        if (do_read) {
+            L.latency.check_read(read_data, L.cycle);
+            L.reads++;
+            if (L.reads % FIFO_DEPTH == 0) L.coverage.record_rollover();
+        }
+    }
+    L.coverage.sample(dut->empty, dut->full, dut->count, wr_en, rd_en);
+}
+
+void run_lane_group(const TbOptions& opts, std::vector<std::unique_ptr<Lane> >& lanes,
+                    LaneBuffers& b) {
+    TB_PHASE(PH_LANES);
+    int k = (int)lanes.size();
+    b.bank.init();
+
+    // Reset every lane, model lanes alongside
+    for (int l = 0; l < k; l++) {
+        Vfifo* dut = lanes[l]->dut;
+        dut->clk = 0;
+        dut->rst_n = 0;
+        dut->wr_en = 0;
+        dut->rd_en = 0;
+        dut->data_in = 0;
+        lanes[l]->clock.settle();
+        b.stim[l] = FifoStim();
+    }
+    for (int c = 0; c < 5; c++) {
+        for (int l = 0; l < k; l++) {
+            lanes[l]->clock.tick();
+            lanes[l]->cycle++;
+        }
+        b.bank.step(b.stim.data(), b.ref_out.buf());
+    }
+    for (int l = 0; l < k; l++) {
+        lanes[l]->dut->rst_n = 1;
+        lanes[l]->clock.settle();
+        b.stim[l].rst_n = 1;
+    }
+
+    int active = k;
+    for (int c = 0; c < opts.random_cycles && active > 0; c++) {
+        int i = c % LANE_BLOCK;
+        for (int l = 0; l < k; l++) {
+            Lane& L = *lanes[l];
+            if (!L.active) continue;
+            if (i == 0) {
+                TB_PHASE(PH_STIMULUS);
+                L.stim_rng.fill(L.rand_data.data(), LANE_BLOCK, FIFO_DATA_MASK);
+                L.stim_rng.fill(L.rand_coins.data(), LANE_BLOCK / 32);
+            }
+            step_lane(L, l, i, b);
+        }
+
+        // Finished lanes idle: no enables, so model and DUT hold still
+        {
+            TB_PHASE(PH_MODEL);
+            b.bank.step(b.stim.data(), b.ref_out.buf());
+        }
+        for (int l = 0; l < k; l++) {
+            if (!lanes[l]->active) b.rtl_out.set(l, b.ref_out.at(l));
+        }
+
+        {
+            TB_PHASE(PH_COMPARE);
+            if (scoreboard_compare(b.rtl_out, b.ref_out, k, b.mismatch.data())) {
+                for (int w = 0; w < (k + 63) / 64; w++) {
+                    for (uint64_t bits = b.mismatch[w]; bits != 0; bits &= bits - 1) {
+                        int l = w * 64 + __builtin_ctzll(bits);
+                        printf("  [LANE] Seed %llu:\n", (unsigned long long)lanes[l]->seed);
+                        lanes[l]->errors +=
+                            compare_record(b.rtl_out.at(l), b.ref_out.at(l), lanes[l]->cycle);
+                    }
+                }
+            }
+        }
+        {
+            TB_PHASE(PH_MONITOR);
+            MonitorView v = monitor_view(b.stim.data(), b.rtl_out);
+            for (int l = 0; l < k; l++) {
+                Lane& L = *lanes[l];
+                if (L.active && L.monitor.check(v, l, l + 1, L.cycle)) {
+                    printf("  [LANE] Seed %llu: assertion failure above\n", (unsigned long long)L.seed);
+                }
+            }
+        }
+
+        for (int l = 0; l < k; l++) {
+            Lane& L = *lanes[l];
+            if (!L.active || opts.cov_target <= 0) continue;
+            if (L.coverage.get_coverage_percent() >= opts.cov_target) {
+                L.closure_cycle = L.cycle;
+                L.active = false;
+                L.dut->wr_en = 0;
+                L.dut->rd_en = 0;
+                b.stim[l].wr_en = 0;
+                b.stim[l].rd_en = 0;
+                active--;
+            }
+        }
+    }
+}
+
+// Worker for --lanes K: claims K seeds at a time (fewer for the last group)
+void run_lane_worker(const TbOptions& opts, std::atomic<int>& next_seed,
+                     std::vector<SeedResult>& results, ShardTotals& totals) {
+    VerilatedContext contextp;
+    LaneDuts duts(opts.num_lanes, &contextp);
+
+    for (int first = next_seed.fetch_add(opts.num_lanes); first < opts.num_seeds;
+         first = next_seed.fetch_add(opts.num_lanes)) {
+        int k = std::min(opts.num_lanes, opts.num_seeds - first);
+        std::vector<std::unique_ptr<Lane> > lanes;
+        for (int l = 0; l < k; l++) {
+            lanes.emplace_back(new Lane(duts.at(l), opts, opts.base_seed + first + l));
+        }
+        LaneBuffers buffers(k);
+        run_lane_group(opts, lanes, buffers);
+
+        for (int l = 0; l < k; l++) {
+            Lane& L = *lanes[l];
+            SeedResult& r = results[first + l];
+            r.seed = L.seed;
+            r.cycles = L.cycle;
+            r.closure_cycle = L.closure_cycle;
+            r.mismatches = L.errors;
+            r.latency_violations = L.latency.get_violations();
+            r.assertion_failures = (int)L.monitor.total_failures();
+            r.writes = L.writes;
+            r.reads = L.reads;
+            totals.latency.merge(L.latency);
+            totals.coverage.merge(L.coverage);
+            totals.monitor.merge(L.monitor);
+        }
+    }
+}
+
+void run_worker(const TbOptions& opts, std::atomic<int>& next_seed,
+                std::vector<SeedResult>& results, ShardTotals& totals) {
+    if (opts.num_lanes > 1) {
+        run_lane_worker(opts, next_seed, results, totals);
+        return;
+    }
+
+    // Own context per worker: Verilated models are not safe to share across threads
+    VerilatedContext contextp;
+    Vfifo dut(&contextp);
+    FifoModel model;
+
+    for (int i = next_seed.fetch_add(1); i < opts.num_seeds; i = next_seed.fetch_add(1)) {
+        uint64_t seed = opts.base_seed + i;
+        model.init();
+
+        // Per-seed progress stays quiet; failures still report themselves
+        std::unique_ptr<TraceWriter> trace(open_trace(opts, seed, true));
+        TestContext t(&dut, &model, &opts, seed, TB_LOG_ERROR);
+        t.trace = trace.get();
+        if (opts.checkpoint_path) t.checkpoint_file = std::string(opts.checkpoint_path) + "." + std::to_string(seed);
+        run_seed(t);
+
+        results[i] = seed_result(t);
+        if (!t.checkpoint_file.empty() && !results[i].failed()) remove(t.checkpoint_file.c_str());
+        totals.latency.merge(t.latency);
+        totals.coverage.merge(t.coverage);
+        totals.monitor.merge(t.monitor);
+    }
+}
+
+// Results of a multi-seed run, threaded or forked
+int report_regression(const TbOptions& opts, const std::vector<SeedResult>& results,
+                      ShardTotals& merged, double seconds) {
+    int num_seeds = (int)results.size();
+    bool info = log_info(opts);
+
+    long long total_cycles = 0;
+    long long total_mismatches = 0;
+    long long closure_cycles = 0;
+    int max_closure = 0;
+    int closed = 0;
+    int failed = 0;
+    for (const SeedResult& r : results) {
+        total_cycles += r.cycles;
+        total_mismatches += r.mismatches;
+        if (r.closure_cycle >= 0) {
+            closed++;
+            closure_cycles += r.closure_cycle;
+            max_closure = std::max(max_closure, r.closure_cycle);
+        }
+        if (r.failed()) failed++;
+    }
+
+    if (info) {
+        printf("\n==============================================\n");
+        printf("           REGRESSION COMPLETE\n");
+        printf("==============================================\n");
+        printf("\nSeeds run: %d (%.1f seeds/sec)\n", num_seeds, num_seeds / seconds);
+        printf("Total cycles: %lld\n", total_cycles);
+        printf("Stimulus: %s, coverage target %.1f%%\n",
+               opts.stimulus == STIM_DIRECTED ? "directed" : "random", opts.cov_target);
+        printf("Seeds reaching target: %d/%d", closed, num_seeds);
+        if (closed > 0) {
+            printf(" (cycles to closure: avg %.1f, max %d)", (double)closure_cycles / closed, max_closure);
+        }
+        printf("\n");
+        printf("RTL vs Reference mismatches: %lld\n", total_mismatches);
+        printf("Seeds failed: %d\n", failed);
+    }
+    for (const SeedResult& r : results) {
+        if (r.failed()) {
+            printf("  seed %llu: %d mismatches, %d latency violations, %d assertion failures\n",
+                   (unsigned long long)r.seed, r.mismatches, r.latency_violations, r.assertion_failures);
+        }
+    }
+
+    if (info) {
+        merged.latency.print_report();
+        merged.coverage.print_report();
+        merged.monitor.print_report();
+    }
+    write_coverage(merged.coverage, opts.cov_out);
+    write_summary(opts, results, merged.latency, merged.coverage, merged.monitor, seconds);
+    write_result(opts, results, merged.latency, merged.coverage, merged.monitor, seconds);
+    report_phases(opts);
+
+    if (info) printf("\n========== Final Result ==========\n");
+    if (failed == 0) {
+        printf("PASSED - All %d seeds passed!\n", num_seeds);
+    } else {
+        printf("FAILED - %d of %d seeds failed\n", failed, num_seeds);
+        for (const SeedResult& r : results) {
+            if (r.failed()) {
+                printf("Rerun the first failing seed with: --seed %llu\n", (unsigned long long)r.seed);
+                break;
+            }
+        }
+    }
+    return failed > 0 ? 1 : 0;
+}
+
+int run_regression(const TbOptions& opts) {
+    uint64_t base_seed = opts.base_seed;
+    int num_seeds = opts.num_seeds;
+    int num_jobs = opts.num_jobs;
+    bool info = log_info(opts);
+
+    if (info) {
+        printf("==============================================\n");
+        printf("  FIFO Sharded Regression\n");
+        printf("==============================================\n\n");
+        printf("Configuration: DEPTH=%d DATA_WIDTH=%d\n", FIFO_DEPTH, FIFO_DATA_WIDTH);
+        printf("Seeds %llu..%llu on %d worker threads\n", (unsigned long long)base_seed,
+               (unsigned long long)(base_seed + num_seeds - 1), num_jobs);
+        if (opts.num_lanes > 1) {
+            printf("%d lanes per worker (reset and randomized stress test only)\n", opts.num_lanes);
+        }
+        print_clocking(opts);
+    }
+
+    std::vector<SeedResult> results(num_seeds);
+    std::vector<ShardTotals> totals(num_jobs);
+    std::atomic<int> next_seed(0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int j = 0; j < num_jobs; j++) {
+        workers.emplace_back(run_worker, std::cref(opts), std::ref(next_seed),
+                             std::ref(results), std::ref(totals[j]));
+    }
+    for (std::thread& w : workers) w.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ShardTotals merged;
+    for (const ShardTotals& s : totals) {
+        merged.latency.merge(s.latency);
+        merged.coverage.merge(s.coverage);
+        merged.monitor.merge(s.monitor);
+    }
+    return report_regression(opts, results, merged, seconds);
+}
+
+// =============================================================================
+// Forked suite (--fork) - reset once, then every directed test and every
+// seed's randomized stress test in its own child process, each starting from
+// the same post-reset DUT and model (copy-on-write, see fork_pool.h)
+//
+// Unlike the serial suite, no test inherits the FIFO state another left
+// behind, and a seed's coverage closure counts its stress test alone. The
+// directed tests are seed-independent, so their results are reported under
+// the first seed, whose serial rerun contains them.
+// =============================================================================
+struct ForkTest {
+    const char* name;
+    void (*run)(TestContext&);
+};
+
+const ForkTest FORK_TESTS[] = {
+    {"basic_rw", test_basic_rw},
+    {"fill_full", test_fill_full},
+    {"drain_empty", test_drain_empty},
+    {"simultaneous_rw", test_simultaneous_rw},
+    {"pointer_rollover", test_pointer_rollover},
+};
+const int NUM_FORK_TESTS = sizeof(FORK_TESTS) / sizeof(FORK_TESTS[0]);
+
+// A child's reply: these counters (cycles since the shared reset), then the
+// latency checker, coverage and monitor state, each preceded by its length
+enum { FORK_MISMATCHES, FORK_VIOLATIONS, FORK_ASSERTIONS, FORK_CYCLES, FORK_CLOSURE, FORK_WRITES,
+       FORK_READS, FORK_WORDS };
+
+std::vector<uint64_t> fork_reply(TestContext& t, int start_cycle) {
+    if (seed_failed(t)) capture_failure(t);
+
+    std::vector<uint64_t> w = {(uint64_t)t.total_errors, t.latency.get_violations(),
+                               t.monitor.total_failures(), (uint64_t)(t.cycle - start_cycle),
+                               (uint64_t)(int64_t)t.closure_cycle, (uint64_t)t.writes_completed,
+                               (uint64_t)t.reads_completed};
+    std::vector<uint64_t> state;
+    t.latency.save_state(state);
+    w.push_back(state.size());
+    w.insert(w.end(), state.begin(), state.end());
+    t.coverage.save_state(state);
+    w.push_back(state.size());
+    w.insert(w.end(), state.begin(), state.end());
+    t.monitor.save_state(state);
+    w.push_back(state.size());
+    w.insert(w.end(), state.begin(), state.end());
+    return w;
+}
+
+// Add a reply to the result it belongs to; false if the child died or the
+// reply is cut short
+bool fork_merge(const ForkPool::Result& r, SeedResult& into, ShardTotals& totals) {
+    const std::vector<uint64_t>& w = r.words;
+    if (!r.completed() || w.size() < FORK_WORDS + 1) return false;
+    size_t lat_words = w[FORK_WORDS];
+    size_t cov_at = FORK_WORDS + 1 + lat_words;
+    if (w.size() < cov_at + 1) return false;
+    size_t mon_at = cov_at + 1 + w[cov_at];
+    if (w.size() < mon_at + 1 || w.size() != mon_at + 1 + w[mon_at]) return false;
+
+    LatencyChecker latency(MAX_LATENCY, FIFO_DEPTH);
+    CoverageTracker coverage;
+    FifoMonitor monitor;
+    if (!latency.restore_state(std::vector<uint64_t>(&w[FORK_WORDS + 1], &w[cov_at])) ||
+        !coverage.restore_state(std::vector<uint64_t>(w.begin() + cov_at + 1, w.begin() + mon_at)) ||
+        !monitor.restore_state(std::vector<uint64_t>(w.begin() + mon_at + 1, w.end()))) {
+        return false;
+    }
+    totals.latency.merge(latency);
+    totals.coverage.merge(coverage);
+    totals.monitor.merge(monitor);
+
+    into.mismatches += (int)w[FORK_MISMATCHES];
+    into.latency_violations += (int)w[FORK_VIOLATIONS];
+    into.assertion_failures += (int)w[FORK_ASSERTIONS];
+    into.cycles += (int)w[FORK_CYCLES];
+    into.writes += (int)w[FORK_WRITES];
+    into.reads += (int)w[FORK_READS];
+    return true;
+}
+
+int run_forked(const TbOptions& opts) {
+    uint64_t base_seed = opts.base_seed;
+    int num_seeds = opts.num_seeds;
+    bool info = log_info(opts);
+
+    if (info) {
+        printf("==============================================\n");
+        printf("  FIFO Forked Suite\n");
+        printf("==============================================\n\n");
+        printf("Configuration: DEPTH=%d DATA_WIDTH=%d\n", FIFO_DEPTH, FIFO_DATA_WIDTH);
+        printf("Reset once, then %d directed tests and seeds %llu..%llu in up to %d child processes\n",
+               NUM_FORK_TESTS, (unsigned long long)base_seed,
+               (unsigned long long)(base_seed + num_seeds - 1), opts.num_jobs);
+        print_clocking(opts);
+    }
+
+    VerilatedContext contextp;
+    Vfifo dut(&contextp);
+    FifoModel model;
+
+    auto start = std::chrono::steady_clock::now();
+    TestContext base(&dut, &model, &opts, base_seed, TB_LOG_ERROR);
+    run_reset(base);
+
+    // Every seed starts from the shared reset
+    std::vector<SeedResult> results(num_seeds);
+    for (int i = 0; i < num_seeds; i++) {
+        results[i] = seed_result(base);
+        results[i].seed = base_seed + i;
+    }
+
+    std::vector<ForkPool::Result> replies;
+    {
+        ForkPool pool(opts.num_jobs);
+        for (int k = 0; k < NUM_FORK_TESTS; k++) {
+            bool ok = pool.spawn(k, [&]() {
+                TestContext t(&dut, &model, &opts, base_seed, TB_LOG_ERROR);
+                t.cycle = base.cycle;
+                FORK_TESTS[k].run(t);
+                return fork_reply(t, base.cycle);
+            }, replies);
+            if (!ok) replies.push_back(ForkPool::Result{k, -1, std::vector<uint64_t>()});
+        }
+        for (int i = 0; i < num_seeds; i++) {
+            int id = NUM_FORK_TESTS + i;
+            bool ok = pool.spawn(id, [&]() {
+                uint64_t seed = base_seed + i;
+                std::unique_ptr<TraceWriter> trace(open_trace(opts, seed, num_seeds > 1));
+                TestContext t(&dut, &model, &opts, seed, TB_LOG_ERROR);
+                t.cycle = base.cycle;
+                t.trace = trace.get();
+                if (opts.checkpoint_path) {
+                    t.checkpoint_file = opts.checkpoint_path;
+                    if (num_seeds > 1) t.checkpoint_file += "." + std::to_string(seed);
+                }
+                test_random_stress(t);
+                test_burst_stress(t);
+                std::vector<uint64_t> reply = fork_reply(t, base.cycle);
+                if (trace && !trace->is_flight_recorder()) trace->close();
+                if (!t.checkpoint_file.empty() && !seed_failed(t)) {
+                    remove(t.checkpoint_file.c_str());
+                }
+                return reply;
+            }, replies);
+            if (!ok) replies.push_back(ForkPool::Result{id, -1, std::vector<uint64_t>()});
+        }
+        pool.wait_all(replies);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ShardTotals merged;
+    std::sort(replies.begin(), replies.end(),
+              [](const ForkPool::Result& a, const ForkPool::Result& b) { return a.id < b.id; });
+    if (info) printf("\nDirected tests:\n");
+    for (const ForkPool::Result& r : replies) {
+        bool directed = r.id < NUM_FORK_TESTS;
+        SeedResult& into = results[directed ? 0 : r.id - NUM_FORK_TESTS];
+        int before = into.mismatches + into.latency_violations + into.assertion_failures;
+        bool ok = fork_merge(r, into, merged);
+        if (!directed && ok) into.closure_cycle = (int)(int64_t)r.words[FORK_CLOSURE];
+
+        char name[64];
+        if (directed) {
+            snprintf(name, sizeof(name), "test %s", FORK_TESTS[r.id].name);
+        } else {
+            snprintf(name, sizeof(name), "seed %llu", (unsigned long long)into.seed);
+        }
+        if (!ok) {
+            // A crashed child counts as a failure of what it was running
+            into.mismatches++;
+            if (r.status == -1) {
+                printf("  [FORK] %s: could not start a child process\n", name);
+            } else if (WIFSIGNALED(r.status)) {
+                printf("  [FORK] %s: child killed by signal %d\n", name, WTERMSIG(r.status));
+            } else {
+                printf("  [FORK] %s: child exited without a complete result\n", name);
+            }
+        } else if (directed && info) {
+            bool failed = into.mismatches + into.latency_violations + into.assertion_failures > before;
+            printf("  %-18s %s (%d cycles)\n", FORK_TESTS[r.id].name, failed ? "FAILED" : "passed",
+                   (int)r.words[FORK_CYCLES]);
+        }
+    }
+    return report_regression(opts, results, merged, seconds);
+}
+
+#ifdef TB_FAULTS
+// =============================================================================
+// Fault-injection campaign (--faults N, FAULTS=1 builds) - how many of the
+// bit flips of fault_inject.h the checkers above catch, and how fast
+//
+// The golden run resets the FIFO and runs --cycles cycles of the stress
+// test's stimulus under every check, recording the stimulus and the register
+// digest after each edge. A replay of it then pauses every --fault-interval
+// cycles and forks one child per fault due in the next interval: the fork is
+// the snapshot, a copy-on-write image of DUT, model and checkers at that
+// cycle (see fork_pool.h). The child replays on to the fault's cycle, flips
+// the bit and keeps replaying under the same checks, in short blocks, until
+// a checker fails (detected), the digest matches the golden run's again
+// (masked) or --fault-window cycles pass (latent).
+// =============================================================================
+
+// Cycles a faulty run is checked in at a time
+const int FAULT_BLOCK = 64;
+
+// The golden run's record, and the progress of a run along it
+struct FaultCampaign {
+    TestContext& t;
+    std::vector<FifoStim>& stim;     // per campaign cycle
+    std::vector<uint64_t>& golden;   // register digest after each edge
+    uint64_t memory_hash;
+    uint64_t done;                   // campaign cycles run
+
+    FaultCampaign(TestContext& ctx, std::vector<FifoStim>& s, std::vector<uint64_t>& g) :
+        t(ctx), stim(s), golden(g), memory_hash(0), done(0) {}
+};
+
+// What one block found: the first entry each checker failed on, and the
+// first whose state matched the golden run's (-1 where none did)
+struct FaultBlock {
+    int scoreboard;
+    int latency;
+    int assertion;
+    int reconverged;
+
+    bool failed() const { return scoreboard >= 0 || latency >= 0 || assertion >= 0; }
+};
+
+// Reset the DUT and model, and clear the FIFO memory (reset leaves it alone),
+// so the golden run and its replay start from the same state
+void fault_reset(FaultCampaign& c) {
+    run_reset(c.t);
+    auto* r = c.t.dut->rootp;
+    for (uint32_t i = 0; i < FIFO_DEPTH; i++) r->fifo__DOT__memory[i] = 0;
+    c.t.clock.settle();
+    c.memory_hash = fault_memory_hash(r);
+    c.done = 0;
+}
+
+// Run the next n (<= BATCH_CYCLES) campaign cycles with every check of the
+// stress test: generated and recorded with gen (the golden run), replayed
+// from the record without
+FaultBlock fault_step(FaultCampaign& c, int n, StimulusGenerator* gen) {
+    TestContext& t = c.t;
+    Vfifo* dut = t.dut;
+    auto* r = dut->rootp;
+    FaultBlock b = {-1, -1, -1, -1};
+    uint64_t first = c.done;
+    int first_cycle = t.cycle;
+
+    if (gen) {
+        t.stim_rng.fill(t.rand_data.data(), n, FIFO_DATA_MASK);
+        t.stim_rng.fill(t.rand_coins.data(), (n + 31) / 32);
+    }
+    for (int i = 0; i < n; i++) {
+        FifoStim& s = c.stim[first + i];
+        if (gen) {
+            bool wr_en, rd_en;
+            gen->next(dut->count, t.rand_coins[i / 32] >> (2 * (i % 32)), &wr_en, &rd_en);
+            s.data_in = t.rand_data[i];
+            s.wr_en = wr_en;
+            s.rd_en = rd_en;
+            s.rst_n = dut->rst_n;
+        }
+        bool do_write = s.wr_en && !dut->full;
+        bool do_read = s.rd_en && !dut->empty;
+        fifo_data_t read_data = dut->data_out;
+
+        dut->wr_en = s.wr_en;
+        dut->rd_en = s.rd_en;
+        dut->data_in = s.data_in;
+
+        // The edge can only write memory[wr_ptr]
+        uint32_t p = r->fifo__DOT__wr_ptr;
+        uint64_t before = p < FIFO_DEPTH ? (uint64_t)r->fifo__DOT__memory[p] : 0;
+        tick_dut(t);
+        if (p < FIFO_DEPTH) c.memory_hash += fault_mix(p, r->fifo__DOT__memory[p]) - fault_mix(p, before);
+        uint64_t digest = fault_digest(r, c.memory_hash);
+        if (gen) {
+            c.golden[first + i] = digest;
+        } else if (b.reconverged < 0 && digest == c.golden[first + i]) {
+            b.reconverged = i;
+        }
+
+        FifoOut rtl;
+        sample_outputs(dut, &rtl);
+        t.rtl_out.set(i, rtl);
+        if (do_write) {
+            t.latency.record_write(s.data_in, t.cycle);
+            t.writes_completed++;
+        }
+        if (do_read) {
+            if (!t.latency.check_read(read_data, t.cycle) && b.latency < 0) b.latency = i;
+            t.reads_completed++;
+            if (gen && t.reads_completed % FIFO_DEPTH == 0) t.coverage.record_rollover();
+        }
+        if (gen) t.coverage.sample(dut->empty, dut->full, dut->count, s.wr_en, s.rd_en);
+    }
+
+    t.model->step_batch(&c.stim[first], t.ref_out.buf(), n);
+    if (scoreboard_compare(t.rtl_out, t.ref_out, n, t.mismatch.data())) {
+        for (int w = 0; b.scoreboard < 0; w++) {
+            if (t.mismatch[w]) b.scoreboard = w * 64 + __builtin_ctzll(t.mismatch[w]);
+        }
+    }
+    if (t.monitor.check(monitor_view(&c.stim[first], t.rtl_out), 0, n, first_cycle + 1)) {
+        b.assertion = (int)(t.monitor.first_failure() - (first_cycle + 1));
+    }
+    c.done += n;
+    return b;
+}
+
+// Replay up to (not including) campaign cycle end, in whole batches
+void fault_replay(FaultCampaign& c, uint64_t end) {
+    while (c.done < end) fault_step(c, (int)std::min<uint64_t>(end - c.done, BATCH_CYCLES), NULL);
+}
+
+// A child's reply: outcome, DETECT_* bits, and edges from the flip to the
+// detection or reconvergence (1 = the edge the fault was injected before)
+enum { FAULT_REPLY_OUTCOME, FAULT_REPLY_DETECTORS, FAULT_REPLY_CYCLES, FAULT_REPLY_WORDS };
+
+std::vector<uint64_t> run_fault(FaultCampaign& c, const Fault& f, int window) {
+    // Every checker prints its failures; only the verdict is wanted here
+    if (!freopen("/dev/null", "w", stdout)) {}
+    fault_replay(c, f.cycle);
+    c.memory_hash += fault_flip(c.t.dut->rootp, f);
+    c.t.clock.settle();
+
+    uint64_t end = std::min<uint64_t>(f.cycle + window, c.golden.size());
+    while (c.done < end) {
+        uint64_t first = c.done;
+        FaultBlock b = fault_step(c, (int)std::min<uint64_t>(end - first, FAULT_BLOCK), NULL);
+        int at = b.failed() ? INT32_MAX : -1;
+        if (b.scoreboard >= 0) at = std::min(at, b.scoreboard);
+        if (b.latency >= 0) at = std::min(at, b.latency);
+        if (b.assertion >= 0) at = std::min(at, b.assertion);
+
+        // Outputs follow the state, so a check can fail on the cycle the
+        // state reconverges (a read that left before it), but not after it
+        if (at >= 0 && (b.reconverged < 0 || at <= b.reconverged)) {
+            uint64_t detectors = (b.scoreboard == at ? DETECT_SCOREBOARD : 0) |
+                                 (b.latency == at ? DETECT_LATENCY : 0) |
+                                 (b.assertion == at ? DETECT_ASSERTION : 0);
+            return {FAULT_DETECTED, detectors, first + at - f.cycle + 1};
+        }
+        if (b.reconverged >= 0) return {FAULT_MASKED, 0, first + b.reconverged - f.cycle + 1};
+    }
+    return {FAULT_LATENT, 0, end - f.cycle};
+}
+
+// --fault-log: the fault, its outcome and the checkers that caught it
+void write_fault_log(const char* path, const std::vector<Fault>& faults,
+                     const std::vector<ForkPool::Result>& replies) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Could not write fault log %s\n", path);
+        return;
+    }
+    fprintf(f, "fault,cycle,target,index,bit,outcome,detected_by,cycles\n");
+    for (const ForkPool::Result& r : replies) {
+        const Fault& x = faults[r.id];
+        bool ok = r.completed() && r.words.size() == FAULT_REPLY_WORDS;
+        uint64_t d = ok ? r.words[FAULT_REPLY_DETECTORS] : 0;
+        std::string by;
+        if (d & DETECT_SCOREBOARD) by += "+scoreboard";
+        if (d & DETECT_LATENCY) by += "+latency";
+        if (d & DETECT_ASSERTION) by += "+assertion";
+        fprintf(f, "%d,%llu,%s,%u,%u,%s,%s,%llu\n", r.id, (unsigned long long)x.cycle,
+                FAULT_TARGET_NAMES[x.target], x.index, x.bit,
+                FAULT_OUTCOME_NAMES[ok ? r.words[FAULT_REPLY_OUTCOME] : (uint64_t)FAULT_CRASHED],
+                by.empty() ? "" : by.c_str() + 1,
+                (unsigned long long)(ok ? r.words[FAULT_REPLY_CYCLES] : 0));
+    }
+    if (fclose(f) != 0) fprintf(stderr, "Could not write fault log %s\n", path);
+}
+
+int run_faults(const TbOptions& opts) {
+    uint64_t cycles = opts.random_cycles;
+    if (cycles == 0) {
+        fprintf(stderr, "--faults needs a golden run of at least one cycle (--cycles)\n");
+        return 1;
+    }
+    std::string targets;
+    for (int k = 0; k < FAULT_TARGETS; k++) {
+        if (!(opts.fault_targets & (1u << k))) continue;
+        targets += std::string(targets.empty() ? "" : ",") + FAULT_TARGET_NAMES[k];
+    }
+
+    printf("==============================================\n");
+    printf("  FIFO Fault-Injection Campaign\n");
+    printf("==============================================\n\n");
+    printf("Configuration: DEPTH=%d DATA_WIDTH=%d\n", FIFO_DEPTH, FIFO_DATA_WIDTH);
+    printf("Seed: %llu\n", (unsigned long long)opts.base_seed);
+    printf("Golden run: %llu cycles of %s stimulus, snapshot every %d cycles\n", (unsigned long long)cycles,
+           opts.stimulus == STIM_DIRECTED ? "coverage-directed" : "random", opts.fault_interval);
+    printf("Faults: %d single bit flips in %s, each followed for up to %d cycles, %d at a time\n",
+           opts.fault_count, targets.c_str(), opts.fault_window, opts.num_jobs);
+    print_clocking(opts);
+
+    VerilatedContext contextp;
+    Vfifo dut(&contextp);
+    std::vector<FifoStim> stim(cycles);
+    std::vector<uint64_t> golden(cycles);
+
+    // Pass 1: the golden run, which has to pass
+    auto start = std::chrono::steady_clock::now();
+    FifoModel golden_model;
+    TestContext g(&dut, &golden_model, &opts, opts.base_seed, TB_LOG_ERROR);
+    FaultCampaign gc(g, stim, golden);
+    fault_reset(gc);
+    StimulusGenerator gen(opts.stimulus, g.coverage, g.rng);
+    while (gc.done < cycles) {
+        uint64_t first = gc.done;
+        FaultBlock b = fault_step(gc, (int)std::min<uint64_t>(cycles - first, BATCH_CYCLES), &gen);
+        if (b.failed() || g.total_errors) {
+            printf("\nFAILED - the golden run fails in cycles %llu..%llu; fix that first (rerun the "
+                   "tests with --seed %llu)\n", (unsigned long long)first, (unsigned long long)gc.done - 1,
+                   (unsigned long long)opts.base_seed);
+            return 1;
+        }
+    }
+    double golden_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("\nGolden run: %llu cycles in %.2fs, coverage %.1f%%\n", (unsigned long long)cycles,
+           golden_seconds, g.coverage.get_coverage_percent());
+
+    Xoshiro256 rng(opts.base_seed, STREAM_FAULTS);
+    std::vector<Fault> faults = fault_sample(rng, opts.fault_count, cycles, opts.fault_targets);
+
+    // Pass 2: replay, forking the faults of each interval at its start
+    start = std::chrono::steady_clock::now();
+    FifoModel model;
+    TestContext t(&dut, &model, &opts, opts.base_seed, TB_LOG_ERROR);
+    FaultCampaign c(t, stim, golden);
+    fault_reset(c);
+    std::vector<ForkPool::Result> replies;
+    {
+        ForkPool pool(opts.num_jobs);
+        size_t next = 0;
+        while (next < faults.size()) {
+            if (c.done > 0 && fault_digest(dut.rootp, c.memory_hash) != golden[c.done - 1]) {
+                printf("\nFAILED - the replay left the golden run by cycle %llu; the model is not "
+                       "deterministic\n", (unsigned long long)c.done);
+                return 1;
+            }
+            uint64_t end = std::min<uint64_t>(c.done + opts.fault_interval, cycles);
+            for (; next < faults.size() && faults[next].cycle < end; next++) {
+                int id = (int)next;
+                bool ok = pool.spawn(id, [&]() { return run_fault(c, faults[id], opts.fault_window); },
+                                     replies);
+                if (!ok) replies.push_back(ForkPool::Result{id, -1, std::vector<uint64_t>()});
+            }
+            fault_replay(c, end);
+        }
+        pool.wait_all(replies);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::sort(replies.begin(), replies.end(),
+              [](const ForkPool::Result& a, const ForkPool::Result& b) { return a.id < b.id; });
+    FaultStats stats;
+    for (const ForkPool::Result& r : replies) {
+        if (r.completed() && r.words.size() == FAULT_REPLY_WORDS) {
+            stats.record(faults[r.id], (int)r.words[FAULT_REPLY_OUTCOME],
+                         (unsigned)r.words[FAULT_REPLY_DETECTORS], r.words[FAULT_REPLY_CYCLES]);
+        } else {
+            stats.record(faults[r.id], FAULT_CRASHED, 0, 0);
         }
     }
-    coverage.record_rollover();
-    printf("  Pointer rollover test complete\n");
+    printf("Campaign: %d faults in %.2fs (%.0f faults/s)\n", opts.fault_count, seconds,
+           seconds > 0 ? opts.fault_count / seconds : 0.0);
+    stats.print_report();
+    g.coverage.print_report();
+    if (opts.fault_log) write_fault_log(opts.fault_log, faults, replies);
+
+    if (opts.summary_path) {
+        RunSummary s;
+        s.add("testbench", "tb_fifo");
+        s.add("mode", "faults");
+        s.add("depth", FIFO_DEPTH);
+        s.add("data_width", FIFO_DATA_WIDTH);
+        s.add("seed", opts.base_seed);
+        s.add("golden_cycles", cycles);
+        s.add("coverage_percent", g.coverage.get_coverage_percent());
+        s.add("faults", opts.fault_count);
+        s.add("fault_window", opts.fault_window);
+        s.add("jobs", opts.num_jobs);
+        s.add("seconds", golden_seconds + seconds);
+        for (int o = 0; o < FAULT_OUTCOMES; o++) s.add(FAULT_OUTCOME_NAMES[o], stats.count(o));
+        s.add("detection_rate", stats.detection_rate());
+        s.add("mean_cycles_to_detection", stats.mean_latency());
+        if (!s.write(opts.summary_path)) fprintf(stderr, "Could not write summary %s\n", opts.summary_path);
+    }
+    return 0;
+}
+#endif
+
+// =============================================================================
+// Main Testbench
+// =============================================================================
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    TbOptions opts = parse_options(argc, argv);
+
+#ifdef TB_FAULTS
+    if (opts.fault_count > 0) {
+        return run_faults(opts);
+    }
+#endif
+    if (opts.fork) {
+        return run_forked(opts);
+    }
+    if (opts.num_seeds > 1) {
+        return run_regression(opts);
+    }
+
+    Vfifo* dut = new Vfifo;
+    FifoModel model;
+    bool info = log_info(opts);
+
+    std::unique_ptr<TraceWriter> trace(open_trace(opts, opts.base_seed, false));
+    TestContext t(dut, &model, &opts, opts.base_seed, opts.log_level);
+    t.trace = trace.get();
+    if (opts.checkpoint_path) t.checkpoint_file = opts.checkpoint_path;
+    if (opts.restore_path && !load_checkpoint(t, opts.restore_path)) {
+        delete dut;
+        return 1;
+    }
+    StimReplay replay;
+    if (opts.replay_path) {
+        const char* error;
+        if (replay.open(opts.replay_path, &error) && replay.layout() != STIM_FIFO) {
+            error = "recorded for the counter, not the FIFO";
+        }
+        if (error) {
+            fprintf(stderr, "Cannot replay %s: %s\n", opts.replay_path, error);
+            delete dut;
+            return 1;
+        }
+        t.replay = &replay;
+    }
+
+    if (info) {
+        printf("==============================================\n");
+        printf("  FIFO Verification with Latency Checking\n");
+        printf("==============================================\n\n");
+        printf("Configuration: DEPTH=%d DATA_WIDTH=%d\n", FIFO_DEPTH, FIFO_DATA_WIDTH);
+        printf("Seed: %llu\n", (unsigned long long)t.seed);
+        print_clocking(opts);
+        if (t.restored) printf("Restored: %s at cycle %d\n", opts.restore_path, t.cycle);
+        if (t.replay) {
+            printf("Replay: %s (%llu cycles, %llu reset points)\n", opts.replay_path,
+                   (unsigned long long)replay.size(), (unsigned long long)replay.reset_points());
+            if (replay.data_width() > FIFO_DATA_WIDTH) {
+                printf("  Recorded data is %u bits wide, this configuration keeps the low %d\n",
+                       replay.data_width(), FIFO_DATA_WIDTH);
+            }
+        }
+        printf("\n");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    run_seed(t);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (trace && !trace->is_flight_recorder()) trace->close();
 
     // -------------------------------------------------------------------------
     // Final Reports
     // -------------------------------------------------------------------------
-    printf("\n==============================================\n");
-    printf("           VERIFICATION COMPLETE\n");
-    printf("==============================================\n");
-    printf("\nTotal cycles: %d\n", cycle);
-    printf("Writes completed: %d\n", writes_completed);
-    printf("Reads completed: %d\n", reads_completed);
-    printf("RTL vs Reference mismatches: %d\n", total_errors);
-
-    latency.print_report();
-    coverage.print_report();
+    if (info) {
+        printf("\n==============================================\n");
+        printf("           VERIFICATION COMPLETE\n");
+        printf("==============================================\n");
+        printf("\nTotal cycles: %d\n", t.cycle);
+        printf("Writes completed: %d\n", t.writes_completed);
+        printf("Reads completed: %d\n", t.reads_completed);
+        printf("RTL vs Reference mismatches: %d\n", t.total_errors);
+        print_closure(t);
+        if (trace && !trace->is_flight_recorder()) {
+            printf("Trace written to %s%s\n", trace->get_path(), trace->ok() ? "" : " (write errors)");
+        }
 
-    printf("\n========== Final Result ==========\n");
-    int latency_errors = latency.get_violations();
-    if (total_errors == 0 && latency_errors == 0) {
+        t.latency.print_report();
+        t.coverage.print_report();
+        t.monitor.print_report();
+    }
+    write_coverage(t.coverage, opts.cov_out);
+    write_summary(opts, std::vector<SeedResult>(1, seed_result(t)), t.latency, t.coverage, t.monitor,
+                  seconds);
+    write_result(opts, std::vector<SeedResult>(1, seed_result(t)), t.latency, t.coverage, t.monitor,
+                 seconds);
+    report_phases(opts);
+
+    if (info) printf("\n========== Final Result ==========\n");
+    int latency_errors = t.latency.get_violations();
+    int assertion_errors = (int)t.monitor.total_failures();
+    bool failed = seed_failed(t);
+    if (!failed) {
         printf("PASSED - All tests passed!\n");
+    } else if (t.replay) {
+        printf("FAILED - %d mismatches, %d assertion failures replaying %s\n", t.total_errors,
+               assertion_errors, opts.replay_path);
     } else {
-        printf("FAILED - %d mismatches, %d latency violations\n", total_errors, latency_errors);
+        printf("FAILED - %d mismatches, %d latency violations, %d assertion failures "
+               "(seed %llu, rerun with --seed %llu)\n",
+               t.total_errors, latency_errors, assertion_errors, (unsigned long long)t.seed,
+               (unsigned long long)t.seed);
     }
 
     delete dut;
-    return (total_errors + latency_errors) > 0 ? 1 : 0;
+    return failed ? 1 : 0;
 }
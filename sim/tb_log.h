@@ -0,0 +1,171 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// =============================================================================
+// Testbench logging
+//
+// Runtime levels (--log-level):
+//   error  mismatches, failures and the final result only
+//   info   banners, test progress and reports (the default)
+//   debug  also every per-cycle / per-transaction message as it happens
+//
+// Building with -DTB_LOG_MAX=TB_LOG_ERROR compiles every info and debug
+// message out of the testbench entirely.
+//
+// Per-cycle messages are not formatted as they happen (unless at debug
+// level): they go into an EventLog, a preallocated ring of binary records,
+// and are only formatted if the run fails.
+// =============================================================================
+#define TB_LOG_ERROR 0
+#define TB_LOG_INFO  1
+#define TB_LOG_DEBUG 2
+
+#ifndef TB_LOG_MAX
+#define TB_LOG_MAX TB_LOG_DEBUG
+#endif
+
+// "error"/"info"/"debug" or a number; -1 if not recognized
+inline int parse_log_level(const char* s) {
+    if (strcmp(s, "error") == 0) return TB_LOG_ERROR;
+    if (strcmp(s, "info") == 0) return TB_LOG_INFO;
+    if (strcmp(s, "debug") == 0) return TB_LOG_DEBUG;
+    if (s[0] >= '0' && s[0] <= '2' && s[1] == '\0') return s[0] - '0';
+    return -1;
+}
+
+// =============================================================================
+// EventLog - the last N per-cycle messages as (cycle, format, arguments)
+//
+// Format strings must be literals and may only use 64-bit integer
+// conversions (%llu, %lld, %llx): every argument is stored, and later passed
+// to printf, as unsigned long long.
+// =============================================================================
+class EventLog {
+private:
+    struct Event {
+        uint64_t cycle;
+        const char* fmt;
+        uint64_t args[4];
+    };
+
+    std::vector<Event> ring;
+    uint64_t count;
+
+public:
+    explicit EventLog(size_t capacity) : ring(capacity), count(0) {}
+
+    void record(uint64_t cycle, const char* fmt, uint64_t a = 0, uint64_t b = 0,
+                uint64_t c = 0, uint64_t d = 0) {
+        if (TB_LOG_MAX < TB_LOG_DEBUG || ring.empty()) return;
+        Event& e = ring[count % ring.size()];
+        e.cycle = cycle;
+        e.fmt = fmt;
+        e.args[0] = a;
+        e.args[1] = b;
+        e.args[2] = c;
+        e.args[3] = d;
+        count++;
+    }
+
+    uint64_t size() const { return count < ring.size() ? count : ring.size(); }
+
+    // Format the retained events, oldest first, each prefixed with its cycle
+    void dump(FILE* out, const char* indent = "  ") const {
+        flockfile(out);
+        for (uint64_t k = count - size(); k < count; k++) {
+            const Event& e = ring[k % ring.size()];
+            fprintf(out, "%s[cycle %llu] ", indent, (unsigned long long)e.cycle);
+            fprintf(out, e.fmt, (unsigned long long)e.args[0], (unsigned long long)e.args[1],
+                    (unsigned long long)e.args[2], (unsigned long long)e.args[3]);
+        }
+        funlockfile(out);
+    }
+
+    void clear() { count = 0; }
+};
+
+// =============================================================================
+// RunSummary - flat machine-readable results, written at exit as JSON or CSV
+// (chosen by the file extension; "-" writes JSON to stdout)
+// =============================================================================
+class RunSummary {
+private:
+    // Key and already-formatted JSON value
+    std::vector<std::pair<std::string, std::string> > fields;
+
+    static std::string quote(const std::string& s) {
+        std::string q = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\') q += '\\';
+            q += c;
+        }
+        return q + "\"";
+    }
+
+public:
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value>::type add(const char* key, T v) {
+        fields.emplace_back(key, std::to_string(v));
+    }
+    void add(const char* key, bool v) { fields.emplace_back(key, v ? "true" : "false"); }
+    void add(const char* key, double v) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.6g", v);
+        fields.emplace_back(key, buf);
+    }
+    void add(const char* key, const char* v) { fields.emplace_back(key, quote(v)); }
+
+    void add(const char* key, const std::vector<uint64_t>& list) {
+        std::string s = "[";
+        for (size_t i = 0; i < list.size(); i++) {
+            if (i) s += ",";
+            s += std::to_string(list[i]);
+        }
+        fields.emplace_back(key, s + "]");
+    }
+
+    bool write(const char* path) const {
+        size_t len = strlen(path);
+        bool csv = len >= 4 && strcmp(path + len - 4, ".csv") == 0;
+        FILE* f = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+        if (!f) return false;
+
+        if (csv) {
+            // One header row, one value row; lists become space-separated strings
+            for (size_t i = 0; i < fields.size(); i++) {
+                fprintf(f, "%s%s", i ? "," : "", fields[i].first.c_str());
+            }
+            fprintf(f, "\n");
+            for (size_t i = 0; i < fields.size(); i++) {
+                std::string v = fields[i].second;
+                if (!v.empty() && v[0] == '[') {
+                    v = v.substr(1, v.size() - 2);
+                    for (char& c : v) {
+                        if (c == ',') c = ' ';
+                    }
+                    v = "\"" + v + "\"";
+                }
+                fprintf(f, "%s%s", i ? "," : "", v.c_str());
+            }
+            fprintf(f, "\n");
+        } else {
+            fprintf(f, "{\n");
+            for (size_t i = 0; i < fields.size(); i++) {
+                fprintf(f, "  %s: %s%s\n", quote(fields[i].first).c_str(), fields[i].second.c_str(),
+                        i + 1 < fields.size() ? "," : "");
+            }
+            fprintf(f, "}\n");
+        }
+
+        bool ok = !ferror(f);
+        if (f != stdout) ok = fclose(f) == 0 && ok;
+        return ok;
+    }
+};
@@ -0,0 +1,320 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// =============================================================================
+// Binary cycle trace - a compact alternative to VCD for debugging mismatches
+//
+// File layout (all integers little-endian):
+//   "RTLTRACE"  u32 version  u32 num_signals
+//   per signal: u8 name length, name bytes, u8 width in bits
+//   records until end of file, each:
+//     varint  cycle - previous record's cycle (the first record: its cycle)
+//     varint  bitmask of the signals that changed since the previous record
+//     varint  new value of each changed signal, in signal order
+// The first record of a file always marks every signal as changed.
+//
+// Streaming mode encodes each sample into one of two fixed-size pages; a full
+// page is handed to a background thread that writes it while the other one
+// fills, so the simulation never blocks on the disk unless the writer falls
+// a full page behind. Flight recorder mode keeps only the raw values of the
+// last N samples in a ring and writes them out once, when triggered (e.g. on
+// the first mismatch); runs that never trigger never touch the disk.
+// =============================================================================
+
+struct TraceSignal {
+    const char* name;
+    int width;     // bits, 1..64
+};
+
+class TraceWriter {
+private:
+    static const uint32_t VERSION = 1;
+    static const size_t PAGE_SIZE = 64 * 1024;
+
+    struct Page {
+        std::vector<uint8_t> bytes;
+        size_t used;
+        bool pending;   // handed to the writer thread
+    };
+
+    std::string path;
+    std::vector<TraceSignal> signals;
+    size_t n;
+    FILE* file;
+    std::atomic<bool> failed;   // also set by the writer thread
+
+    // Delta encoder state
+    std::vector<uint64_t> prev;
+    uint64_t prev_cycle;
+    bool first_record;
+
+    // Streaming: double-buffered pages and the background writer
+    Page pages[2];
+    int active;
+    std::mutex lock;
+    std::condition_variable cv;
+    std::thread writer;
+    bool stopping;
+
+    // Flight recorder: ring of the last flight_cycles samples
+    size_t flight_cycles;
+    std::vector<uint64_t> ring_values;   // flight_cycles x n
+    std::vector<uint64_t> ring_cycles;
+    uint64_t ring_count;
+    bool triggered;
+
+    static size_t put_varint(uint8_t* p, uint64_t v) {
+        size_t len = 0;
+        while (v >= 0x80) {
+            p[len++] = (uint8_t)(v | 0x80);
+            v >>= 7;
+        }
+        p[len++] = (uint8_t)v;
+        return len;
+    }
+
+    // Worst case for one record: cycle delta, mask and every value at 10 bytes
+    size_t max_record() const { return (n + 2) * 10; }
+
+    bool open_file() {
+        file = fopen(path.c_str(), "wb");
+        if (!file) {
+            failed = true;
+            return false;
+        }
+        uint32_t hdr[2] = {VERSION, (uint32_t)n};
+        fwrite("RTLTRACE", 1, 8, file);
+        fwrite(hdr, sizeof(hdr), 1, file);
+        for (const TraceSignal& s : signals) {
+            uint8_t len = (uint8_t)strlen(s.name);
+            uint8_t width = (uint8_t)s.width;
+            fwrite(&len, 1, 1, file);
+            fwrite(s.name, 1, len, file);
+            fwrite(&width, 1, 1, file);
+        }
+        return true;
+    }
+
+    size_t encode(uint8_t* p, uint64_t cycle, const uint64_t* values) {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < n; i++) {
+            mask |= (uint64_t)(first_record || values[i] != prev[i]) << i;
+        }
+        size_t len = put_varint(p, first_record ? cycle : cycle - prev_cycle);
+        len += put_varint(p + len, mask);
+        for (uint64_t m = mask; m != 0; m &= m - 1) {
+            size_t i = __builtin_ctzll(m);
+            len += put_varint(p + len, values[i]);
+            prev[i] = values[i];
+        }
+        prev_cycle = cycle;
+        first_record = false;
+        return len;
+    }
+
+    // Hand the active page to the writer and continue in the other one
+    void submit_page() {
+        std::unique_lock<std::mutex> guard(lock);
+        pages[active].pending = true;
+        cv.notify_all();
+        active ^= 1;
+        cv.wait(guard, [this] { return !pages[active].pending; });
+    }
+
+    void writer_loop() {
+        std::unique_lock<std::mutex> guard(lock);
+        int next = 0;
+        for (;;) {
+            cv.wait(guard, [this, next] { return pages[next].pending || stopping; });
+            if (!pages[next].pending) return;
+
+            Page& page = pages[next];
+            guard.unlock();
+            if (fwrite(page.bytes.data(), 1, page.used, file) != page.used) failed = true;
+            guard.lock();
+            page.used = 0;
+            page.pending = false;
+            cv.notify_all();
+            next ^= 1;
+        }
+    }
+
+public:
+    // flight_cycles == 0 streams every sample to path; otherwise only the
+    // last flight_cycles samples are kept until trigger()
+    TraceWriter(const char* trace_path, const std::vector<TraceSignal>& sigs, size_t flight = 0) :
+        path(trace_path), signals(sigs), n(sigs.size()), file(NULL), failed(false),
+        prev(sigs.size(), 0), prev_cycle(0), first_record(true),
+        active(0), stopping(false),
+        flight_cycles(flight), ring_count(0), triggered(false) {
+        if (n > 64) {
+            fprintf(stderr, "TraceWriter: at most 64 signals per trace\n");
+            n = 64;
+            signals.resize(64);
+        }
+        if (flight_cycles > 0) {
+            ring_values.assign(flight_cycles * n, 0);
+            ring_cycles.assign(flight_cycles, 0);
+            return;
+        }
+
+        for (Page& p : pages) {
+            p.bytes.resize(PAGE_SIZE);
+            p.used = 0;
+            p.pending = false;
+        }
+        if (open_file()) writer = std::thread(&TraceWriter::writer_loop, this);
+    }
+
+    ~TraceWriter() { close(); }
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    bool is_flight_recorder() const { return flight_cycles > 0; }
+    const char* get_path() const { return path.c_str(); }
+    bool ok() const { return !failed; }
+
+    // One sample: values[i] is the value of signal i after this cycle
+    void sample(uint64_t cycle, const uint64_t* values) {
+        if (flight_cycles > 0) {
+            size_t slot = ring_count % flight_cycles;
+            memcpy(&ring_values[slot * n], values, n * sizeof(uint64_t));
+            ring_cycles[slot] = cycle;
+            ring_count++;
+            return;
+        }
+        if (!file) return;
+
+        if (PAGE_SIZE - pages[active].used < max_record()) submit_page();
+        Page& p = pages[active];
+        p.used += encode(p.bytes.data() + p.used, cycle, values);
+    }
+
+    // Flight recorder: write the samples in the ring (oldest first) the first
+    // time this is called. Returns true if this call wrote the file.
+    bool trigger() {
+        if (flight_cycles == 0 || triggered) return false;
+        triggered = true;
+        if (!open_file()) return false;
+
+        uint64_t kept = ring_count < flight_cycles ? ring_count : flight_cycles;
+        std::vector<uint8_t> buf(max_record());
+        for (uint64_t k = ring_count - kept; k < ring_count; k++) {
+            size_t slot = k % flight_cycles;
+            size_t len = encode(buf.data(), ring_cycles[slot], &ring_values[slot * n]);
+            if (fwrite(buf.data(), 1, len, file) != len) failed = true;
+        }
+        if (fclose(file) != 0) failed = true;
+        file = NULL;
+        return true;
+    }
+
+    // Samples the flight recorder holds right now
+    uint64_t flight_size() const {
+        return ring_count < flight_cycles ? ring_count : flight_cycles;
+    }
+    uint64_t first_flight_cycle() const {
+        return flight_size() ? ring_cycles[(ring_count - flight_size()) % flight_cycles] : 0;
+    }
+
+    // Streaming: write the partial page, stop the writer and close the file
+    void close() {
+        if (flight_cycles > 0 || !file) return;
+        if (pages[active].used > 0) submit_page();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+            cv.notify_all();
+        }
+        writer.join();
+        if (fclose(file) != 0) failed = true;
+        file = NULL;
+    }
+};
+
+// =============================================================================
+// TraceReader - decodes a trace written by TraceWriter, one record at a time
+// =============================================================================
+class TraceReader {
+private:
+    FILE* file;
+    std::vector<TraceSignal> signals;
+    std::vector<std::string> names;
+    std::vector<uint64_t> values;
+    uint64_t cycle;
+    bool first;
+
+    bool get_varint(uint64_t* v) {
+        *v = 0;
+        for (int shift = 0; shift < 70; shift += 7) {
+            int c = fgetc(file);
+            if (c == EOF) return false;
+            *v |= (uint64_t)(c & 0x7f) << shift;
+            if (!(c & 0x80)) return true;
+        }
+        return false;
+    }
+
+public:
+    TraceReader() : file(NULL), cycle(0), first(true) {}
+    ~TraceReader() {
+        if (file) fclose(file);
+    }
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool open(const char* path) {
+        file = fopen(path, "rb");
+        if (!file) return false;
+
+        char magic[8];
+        uint32_t hdr[2];
+        if (fread(magic, 1, 8, file) != 8 || memcmp(magic, "RTLTRACE", 8) != 0 ||
+            fread(hdr, sizeof(hdr), 1, file) != 1 || hdr[0] != 1 || hdr[1] > 64) {
+            return false;
+        }
+        names.resize(hdr[1]);
+        for (uint32_t i = 0; i < hdr[1]; i++) {
+            int len = fgetc(file);
+            if (len == EOF) return false;
+            names[i].resize(len);
+            if (len && fread(&names[i][0], 1, len, file) != (size_t)len) return false;
+            int width = fgetc(file);
+            if (width == EOF) return false;
+            signals.push_back(TraceSignal{NULL, width});
+        }
+        for (uint32_t i = 0; i < hdr[1]; i++) signals[i].name = names[i].c_str();
+        values.assign(hdr[1], 0);
+        return true;
+    }
+
+    const std::vector<TraceSignal>& get_signals() const { return signals; }
+
+    // Advance to the next record; false at end of file (or on a torn record)
+    bool next() {
+        uint64_t delta, mask;
+        if (!get_varint(&delta) || !get_varint(&mask)) return false;
+        cycle = first ? delta : cycle + delta;
+        first = false;
+        for (uint64_t m = mask; m != 0; m &= m - 1) {
+            size_t i = __builtin_ctzll(m);
+            if (i >= values.size() || !get_varint(&values[i])) return false;
+        }
+        return true;
+    }
+
+    uint64_t get_cycle() const { return cycle; }
+    const uint64_t* get_values() const { return values.data(); }
+};
@@ -0,0 +1,58 @@
+// Print a binary cycle trace written by the testbenches (--trace) as a
+// table, one line per recorded cycle.
+//
+// usage: trace_dump trace.bin [--from CYCLE] [--to CYCLE]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+int main(int argc, char** argv) {
+    const char* path = NULL;
+    uint64_t from = 0, to = UINT64_MAX;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            from = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            to = strtoull(argv[++i], NULL, 0);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: trace_dump trace.bin [--from CYCLE] [--to CYCLE]\n");
+        return 1;
+    }
+
+    TraceReader trace;
+    if (!trace.open(path)) {
+        fprintf(stderr, "trace_dump: cannot read trace %s\n", path);
+        return 1;
+    }
+
+    // Columns wide enough for the name or the widest hex value
+    const std::vector<TraceSignal>& sigs = trace.get_signals();
+    std::vector<int> col(sigs.size());
+    printf("%10s", "cycle");
+    for (size_t i = 0; i < sigs.size(); i++) {
+        int digits = (sigs[i].width + 3) / 4;
+        col[i] = (int)strlen(sigs[i].name) > digits ? (int)strlen(sigs[i].name) : digits;
+        printf("  %*s", col[i], sigs[i].name);
+    }
+    printf("\n");
+
+    long long records = 0;
+    while (trace.next()) {
+        if (trace.get_cycle() < from) continue;
+        if (trace.get_cycle() > to) break;
+        printf("%10llu", (unsigned long long)trace.get_cycle());
+        for (size_t i = 0; i < sigs.size(); i++) {
+            printf("  %*llx", col[i], (unsigned long long)trace.get_values()[i]);
+        }
+        printf("\n");
+        records++;
+    }
+    fprintf(stderr, "%lld cycles\n", records);
+    return 0;
+}
@@ -1,55 +1,466 @@
 // Reference model for FIFO - the "golden" implementation
 // This is what the RTL should behave like
 
-const DEPTH: usize = 8;
-const DATA_WIDTH: usize = 8;
-
-const FifoState = struct {
-    memory: [DEPTH]u8 = [_]u8{0} ** DEPTH,
-    wr_ptr: usize = 0,
-    rd_ptr: usize = 0,
-    count: usize = 0,
-
-    // Input signals (set by testbench before tick)
-    wr_en: bool = false,
-    rd_en: bool = false,
-    data_in: u8 = 0,
-    rst_n: bool = false,
+const std = @import("std");
+
+// =============================================================================
+// Packed per-cycle records for the batched stepping API. The layouts are
+// shared with sim/fifo_model.h, so keep the two in sync.
+// =============================================================================
+
+// Inputs applied before one rising edge
+const FifoStim = extern struct {
+    data_in: u64,
+    wr_en: u8,
+    rd_en: u8,
+    rst_n: u8,
+    _pad: [5]u8,
 };
 
-var state: FifoState = .{};
+// Outputs observed after that edge
+const FifoOut = extern struct {
+    data_out: u64,
+    count: u32,
+    full: u8,
+    empty: u8,
+    _pad: [2]u8,
+};
 
-// Called on every rising clock edge - mimics the RTL behavior
-export fn fifo_tick() void {
-    if (!state.rst_n) {
-        // Reset: clear pointers and count
-        state.wr_ptr = 0;
-        state.rd_ptr = 0;
-        state.count = 0;
-    } else {
-        const can_write = state.wr_en and (state.count < DEPTH);
-        const can_read = state.rd_en and (state.count > 0);
-
-        // Write operation
-        if (can_write) {
-            state.memory[state.wr_ptr] = state.data_in;
-            state.wr_ptr = (state.wr_ptr + 1) % DEPTH;
+// Structure-of-arrays output streams filled by batched stepping, one entry
+// per cycle, so the testbench scoreboard can compare them with SIMD
+const FifoOutBuf = extern struct {
+    data_out: [*]u64,
+    count: [*]u32,
+    full: [*]u8,
+    empty: [*]u8,
+};
+
+// Returns a FIFO model specialized at comptime for one (DEPTH, DATA_WIDTH)
+// configuration, matching the parameters of rtl/fifo.sv
+fn Fifo(comptime DEPTH: usize, comptime DATA_WIDTH: u16) type {
+    if (DEPTH == 0) @compileError("FIFO depth must be at least 1");
+    if (DATA_WIDTH == 0 or DATA_WIDTH > 64) @compileError("FIFO data width must be 1..64 bits");
+
+    return struct {
+        const Self = @This();
+        pub const Data = std.meta.Int(.unsigned, DATA_WIDTH);
+
+        memory: [DEPTH]Data = [_]Data{0} ** DEPTH,
+        wr_ptr: usize = 0,
+        rd_ptr: usize = 0,
+        count: usize = 0,
+
+        // Input signals (set by testbench before tick)
+        wr_en: bool = false,
+        rd_en: bool = false,
+        data_in: Data = 0,
+        rst_n: bool = false,
+
+        // Pointer increment with wraparound: a mask when DEPTH is a power
+        // of two, otherwise a compare like the RTL's PTR_MAX check
+        fn next(ptr: usize) usize {
+            if (comptime std.math.isPowerOfTwo(DEPTH)) {
+                return (ptr + 1) & (DEPTH - 1);
+            }
+            return if (ptr == DEPTH - 1) 0 else ptr + 1;
+        }
+
+        // Called on every rising clock edge - mimics the RTL behavior
+        fn tick(self: *Self) void {
+            if (!self.rst_n) {
+                // Reset: clear pointers and count
+                self.wr_ptr = 0;
+                self.rd_ptr = 0;
+                self.count = 0;
+            } else {
+                const can_write = self.wr_en and (self.count < DEPTH);
+                const can_read = self.rd_en and (self.count > 0);
+
+                // Write operation
+                if (can_write) {
+                    self.memory[self.wr_ptr] = self.data_in;
+                    self.wr_ptr = next(self.wr_ptr);
+                }
+
+                // Read operation (advances pointer)
+                if (can_read) {
+                    self.rd_ptr = next(self.rd_ptr);
+                }
+
+                // Update count
+                if (can_write and !can_read) {
+                    self.count += 1;
+                } else if (can_read and !can_write) {
+                    self.count -= 1;
+                }
+            }
+        }
+
+        // Pointer advanced by k <= DEPTH entries
+        fn advance(ptr: usize, k: usize) usize {
+            if (comptime std.math.isPowerOfTwo(DEPTH)) {
+                return (ptr + k) & (DEPTH - 1);
+            }
+            const p = ptr + k;
+            return if (p >= DEPTH) p - DEPTH else p;
+        }
+
+        // Copy values into memory starting at slot `at`, wrapping at DEPTH
+        fn store(self: *Self, at: usize, values: []const u64) void {
+            const first = @min(values.len, DEPTH - at);
+            const chunks = [2][]Data{ self.memory[at..][0..first], self.memory[0 .. values.len - first] };
+            const sources = [2][]const u64{ values[0..first], values[first..] };
+            for (chunks, sources) |dst, src| {
+                if (Data == u64) {
+                    @memcpy(dst, src);
+                } else {
+                    for (dst, src) |*m, v| m.* = @truncate(v);
+                }
+            }
+        }
+
+        // Copy k <= count values out of memory starting at slot `at`, wrapping at DEPTH
+        fn load(self: *const Self, at: usize, values: []u64) void {
+            const first = @min(values.len, DEPTH - at);
+            for (values[0..first], self.memory[at..][0..first]) |*v, m| v.* = m;
+            for (values[first..], self.memory[0 .. values.len - first]) |*v, m| v.* = m;
         }
 
-        // Read operation (advances pointer)
-        if (can_read) {
-            state.rd_ptr = (state.rd_ptr + 1) % DEPTH;
+        // Transaction-level fast path for a write burst: the same end state
+        // (latched inputs included) as n tick()s with wr_en=1, rd_en=0 and
+        // data[i] on cycle i, in O(1) plus a copy. Writes past full are
+        // dropped like the RTL drops them. Returns the writes accepted; if
+        // out is given, entry i receives the outputs after cycle i.
+        fn writeBurst(self: *Self, data: []const u64, out: ?*const FifoOutBuf) usize {
+            if (data.len == 0) return 0;
+            self.wr_en = true;
+            self.rd_en = false;
+            self.data_in = @truncate(data[data.len - 1]);
+            if (!self.rst_n) return self.holdInReset(data.len, out);
+
+            const count0 = self.count;
+            const accepted = @min(data.len, DEPTH - count0);
+            self.store(self.wr_ptr, data[0..accepted]);
+            self.wr_ptr = advance(self.wr_ptr, accepted);
+            self.count += accepted;
+
+            // Writes never touch the head slot of a non-empty FIFO, so the
+            // head after the first cycle is the head for the whole burst
+            if (out) |o| {
+                const head = self.dataOut();
+                for (0..data.len) |i| {
+                    const c = @min(count0 + i + 1, DEPTH);
+                    o.data_out[i] = head;
+                    o.count[i] = @intCast(c);
+                    o.full[i] = @intFromBool(c == DEPTH);
+                    o.empty[i] = 0;
+                }
+            }
+            return accepted;
+        }
+
+        // Read burst: as n tick()s with wr_en=0, rd_en=1. Returns the reads
+        // done (the rest hit an empty FIFO); if values is given it receives
+        // the data read, oldest first, and out as for writeBurst.
+        fn readBurst(self: *Self, n: usize, values: ?[*]u64, out: ?*const FifoOutBuf) usize {
+            if (n == 0) return 0;
+            self.wr_en = false;
+            self.rd_en = true;
+            if (!self.rst_n) return self.holdInReset(n, out);
+
+            const count0 = self.count;
+            const rd0 = self.rd_ptr;
+            const reads = @min(n, count0);
+            if (values) |v| self.load(rd0, v[0..reads]);
+            self.rd_ptr = advance(rd0, reads);
+            self.count -= reads;
+
+            if (out) |o| {
+                for (0..n) |i| {
+                    const k = @min(i + 1, count0);
+                    const c = count0 - k;
+                    o.data_out[i] = self.memory[advance(rd0, k)];
+                    o.count[i] = @intCast(c);
+                    o.full[i] = @intFromBool(c == DEPTH);
+                    o.empty[i] = @intFromBool(c == 0);
+                }
+            }
+            return reads;
         }
 
-        // Update count
-        if (can_write and !can_read) {
-            state.count += 1;
-        } else if (can_read and !can_write) {
-            state.count -= 1;
+        // A burst issued while reset is held: every cycle just resets
+        fn holdInReset(self: *Self, n: usize, out: ?*const FifoOutBuf) usize {
+            self.tick();
+            if (out) |o| {
+                for (0..n) |i| {
+                    o.data_out[i] = self.dataOut();
+                    o.count[i] = 0;
+                    o.full[i] = 0;
+                    o.empty[i] = 1;
+                }
+            }
+            return 0;
         }
+
+        fn dataOut(self: *const Self) Data {
+            return self.memory[self.rd_ptr];
+        }
+
+        fn full(self: *const Self) bool {
+            return self.count == DEPTH;
+        }
+
+        fn empty(self: *const Self) bool {
+            return self.count == 0;
+        }
+
+        fn outputs(self: *const Self) FifoOut {
+            return .{
+                .data_out = self.dataOut(),
+                .count = @intCast(self.count),
+                .full = @intFromBool(self.full()),
+                .empty = @intFromBool(self.empty()),
+                ._pad = .{ 0, 0 },
+            };
+        }
+
+        // Lock-step N cycles: apply stim[i], tick, record entry i of each output stream
+        fn stepBatch(self: *Self, stim: []const FifoStim, out: *const FifoOutBuf) void {
+            for (stim, 0..) |in, i| {
+                self.wr_en = in.wr_en != 0;
+                self.rd_en = in.rd_en != 0;
+                self.rst_n = in.rst_n != 0;
+                self.data_in = @truncate(in.data_in);
+                self.tick();
+                out.data_out[i] = self.dataOut();
+                out.count[i] = @intCast(self.count);
+                out.full[i] = @intFromBool(self.full());
+                out.empty[i] = @intFromBool(self.empty());
+            }
+        }
+    };
+}
+
+// =============================================================================
+// Configuration matrix - every (DEPTH, DATA_WIDTH) pair we ship gets its own
+// comptime-specialized model. Add a pair here and a matching entry to
+// FIFO_CONFIGS in the Makefile to verify a new configuration.
+// =============================================================================
+const Config = enum {
+    d8_w8,
+    d16_w8,
+    d16_w32,
+    d64_w16,
+    d1024_w64,
+};
+
+const Params = struct { depth: usize, data_width: u16 };
+
+fn params(comptime c: Config) Params {
+    return switch (c) {
+        .d8_w8 => .{ .depth = 8, .data_width = 8 },
+        .d16_w8 => .{ .depth = 16, .data_width = 8 },
+        .d16_w32 => .{ .depth = 16, .data_width = 32 },
+        .d64_w16 => .{ .depth = 64, .data_width = 16 },
+        .d1024_w64 => .{ .depth = 1024, .data_width = 64 },
+    };
+}
+
+fn Model(comptime c: Config) type {
+    return Fifo(params(c).depth, params(c).data_width);
+}
+
+// =============================================================================
+// Handle-based API - one independent model per handle, so parallel
+// testbench workers never share state
+// =============================================================================
+
+// Opaque to C: the testbench only ever holds a pointer to it
+const FifoHandle = opaque {};
+
+const Instance = struct {
+    config: Config,
+    model: *anyopaque,
+};
+
+fn instance(h: *FifoHandle) *Instance {
+    return @ptrCast(@alignCast(h));
+}
+
+fn model(comptime c: Config, inst: *Instance) *Model(c) {
+    return @ptrCast(@alignCast(inst.model));
+}
+
+// Allocate a new model for the given configuration in its reset state
+// (null if the configuration is not in the matrix or out of memory)
+export fn fifo_create(depth: usize, data_width: u32) ?*FifoHandle {
+    inline for (comptime std.enums.values(Config)) |c| {
+        if (params(c).depth == depth and params(c).data_width == data_width) {
+            const m = std.heap.c_allocator.create(Model(c)) catch return null;
+            m.* = .{};
+            const inst = std.heap.c_allocator.create(Instance) catch {
+                std.heap.c_allocator.destroy(m);
+                return null;
+            };
+            inst.* = .{ .config = c, .model = m };
+            return @ptrCast(inst);
+        }
+    }
+    return null;
+}
+
+// Free a model created by fifo_create
+export fn fifo_destroy(h: ?*FifoHandle) void {
+    const inst = instance(h orelse return);
+    switch (inst.config) {
+        inline else => |c| std.heap.c_allocator.destroy(model(c, inst)),
+    }
+    std.heap.c_allocator.destroy(inst);
+}
+
+export fn fifo_inst_init(h: *FifoHandle) void {
+    const inst = instance(h);
+    switch (inst.config) {
+        inline else => |c| model(c, inst).* = .{},
+    }
+}
+
+export fn fifo_inst_tick(h: *FifoHandle) void {
+    const inst = instance(h);
+    switch (inst.config) {
+        inline else => |c| model(c, inst).tick(),
+    }
+}
+
+export fn fifo_inst_set_reset(h: *FifoHandle, rst_n: bool) void {
+    const inst = instance(h);
+    switch (inst.config) {
+        inline else => |c| model(c, inst).rst_n = rst_n,
+    }
+}
+
+export fn fifo_inst_set_wr_en(h: *FifoHandle, wr_en: bool) void {
+    const inst = instance(h);
+    switch (inst.config) {
+        inline else => |c| model(c, inst).wr_en = wr_en,
+    }
+}
+
+export fn fifo_inst_set_rd_en(h: *FifoHandle, rd_en: bool) void {
+    const inst = instance(h);
+    switch (inst.config) {
+        inline else => |c| model(c, inst).rd_en = rd_en,
+    }
+}
+
+// Data is passed as 64 bits and truncated to DATA_WIDTH, like the RTL port
+export fn fifo_inst_set_data_in(h: *FifoHandle, data: u64) void {
+    const inst = instance(h);
+    switch (inst.config) {
+        inline else => |c| model(c, inst).data_in = @truncate(data),
+    }
+}
+
+export fn fifo_inst_get_data_out(h: *FifoHandle) u64 {
+    const inst = instance(h);
+    return switch (inst.config) {
+        inline else => |c| model(c, inst).dataOut(),
+    };
+}
+
+export fn fifo_inst_get_full(h: *FifoHandle) bool {
+    const inst = instance(h);
+    return switch (inst.config) {
+        inline else => |c| model(c, inst).full(),
+    };
+}
+
+export fn fifo_inst_get_empty(h: *FifoHandle) bool {
+    const inst = instance(h);
+    return switch (inst.config) {
+        inline else => |c| model(c, inst).empty(),
+    };
+}
+
+export fn fifo_inst_get_count(h: *FifoHandle) usize {
+    const inst = instance(h);
+    return switch (inst.config) {
+        inline else => |c| model(c, inst).count,
+    };
+}
+
+// All outputs in one call
+export fn fifo_inst_get_outputs(h: *FifoHandle, out: *FifoOut) void {
+    const inst = instance(h);
+    switch (inst.config) {
+        inline else => |c| out.* = model(c, inst).outputs(),
+    }
+}
+
+// Step n cycles in one call: stim[i] is applied before edge i and entry i
+// of each output stream receives the outputs after it. The inputs of the
+// last record stay latched.
+export fn fifo_inst_step_batch(h: *FifoHandle, stim: [*]const FifoStim, out: *const FifoOutBuf, n: usize) void {
+    const inst = instance(h);
+    switch (inst.config) {
+        inline else => |c| model(c, inst).stepBatch(stim[0..n], out),
     }
 }
 
+// Transaction-level bursts (see writeBurst/readBurst): n cycles of pure
+// writes of data[0..n] / pure reads in one call. Return how many were
+// accepted; out (optional) receives the per-cycle outputs like step_batch,
+// values (optional) the data read.
+export fn fifo_inst_write_burst(h: *FifoHandle, data: [*]const u64, n: usize, out: ?*const FifoOutBuf) usize {
+    const inst = instance(h);
+    return switch (inst.config) {
+        inline else => |c| model(c, inst).writeBurst(data[0..n], out),
+    };
+}
+
+export fn fifo_inst_read_burst(h: *FifoHandle, n: usize, values: ?[*]u64, out: ?*const FifoOutBuf) usize {
+    const inst = instance(h);
+    return switch (inst.config) {
+        inline else => |c| model(c, inst).readBurst(n, values, out),
+    };
+}
+
+// Checkpointing: the whole model (state and latched inputs) as a byte image.
+// An image only restores into a model of the same configuration built from
+// the same source.
+export fn fifo_inst_state_size(h: *FifoHandle) usize {
+    const inst = instance(h);
+    return switch (inst.config) {
+        inline else => |c| @sizeOf(Model(c)),
+    };
+}
+
+export fn fifo_inst_save_state(h: *FifoHandle, buf: [*]u8) void {
+    const inst = instance(h);
+    switch (inst.config) {
+        inline else => |c| @memcpy(buf[0..@sizeOf(Model(c))], std.mem.asBytes(model(c, inst))),
+    }
+}
+
+export fn fifo_inst_restore_state(h: *FifoHandle, buf: [*]const u8) void {
+    const inst = instance(h);
+    switch (inst.config) {
+        inline else => |c| @memcpy(std.mem.asBytes(model(c, inst)), buf[0..@sizeOf(Model(c))]),
+    }
+}
+
+// =============================================================================
+// Single-instance API - kept for existing callers, backed by one global
+// model in the default 8x8 configuration
+// =============================================================================
+
+var state: Model(.d8_w8) = .{};
+
+// Called on every rising clock edge - mimics the RTL behavior
+export fn fifo_tick() void {
+    state.tick();
+}
+
 // Set the reset signal
 export fn fifo_set_reset(rst_n: bool) void {
     state.rst_n = rst_n;
@@ -72,17 +483,17 @@ export fn fifo_set_data_in(data: u8) void {
 
 // Get the data output (always shows head of queue)
 export fn fifo_get_data_out() u8 {
-    return state.memory[state.rd_ptr];
+    return state.dataOut();
 }
 
 // Get the full flag
 export fn fifo_get_full() bool {
-    return state.count == DEPTH;
+    return state.full();
 }
 
 // Get the empty flag
 export fn fifo_get_empty() bool {
-    return state.count == 0;
+    return state.empty();
 }
 
 // Get the current count